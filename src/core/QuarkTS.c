@@ -25,6 +25,11 @@ https://github.com/kmilo17pet/QuarkTS/wiki/APIs
 */
 
 #include "QuarkTS.h"
+#ifdef Q_FD_EVENTS
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <unistd.h>
+#endif
 
 #ifdef __CC_ARM
 #endif
@@ -60,6 +65,48 @@ https://github.com/kmilo17pet/QuarkTS/wiki/APIs
 /*=========================== QuarkTS Private Data ===========================*/
 static volatile QuarkTSCoreData_t QUARKTS;
 static volatile qClock_t _qSysTick_Epochs_ = 0ul;
+static _qTaskPC_t _qCRIdleTaskState_ = qCR_PCInitVal;
+static _qCRPark_t _qCRIdleTaskPark_ = {0ul, 0ul, 0u};
+#ifdef Q_CONCURRENT_POOLS
+    typedef struct{ /*a per-thread cache of free blocks*/
+        qConcurrentPool_t *Pool;
+        uint32_t Count;
+        uint32_t Blocks[Q_CPOOL_MAGAZINE_SIZE];
+    }_qCPoolMagazine_t;
+    static __thread _qCPoolMagazine_t _qCPoolMagazines_[Q_CPOOL_MAGAZINE_SLOTS];
+    static _qCPoolMagazine_t* _qCPool_Magazine(qConcurrentPool_t *Pool);
+    static uint32_t _qCPool_Pop(qConcurrentPool_t *Pool);
+    static void _qCPool_PushChain(qConcurrentPool_t *Pool, const uint32_t First, const uint32_t Last);
+    #define _qCPool_Link(_POOL_, _INDEX_)   ((volatile uint32_t*)((_POOL_)->Blocks + (size_t)(_INDEX_)*(_POOL_)->BlockSize)) /*the free-list links are stored in the free blocks*/
+#endif
+#ifdef Q_ARENA
+    static qArena_t *_qScratchArena_ = NULL; /*reset after every dispatch*/
+    #define _qScheduler_ScratchReset()      if(NULL != _qScratchArena_) _qScratchArena_->Offset = 0u
+#else
+    #define _qScheduler_ScratchReset()
+#endif
+#ifdef Q_MEMORY_MANAGER
+    #define _qMalloc_MaxLog2    16 /*the max request size is 2^16-1 (qSize_t)*/
+    typedef struct{
+        qMemoryPool_t *Pools[Q_MALLOC_MAX_CLASSES]; /*the size classes, sorted by block size*/
+        uint8_t ClassOf[_qMalloc_MaxLog2 + 1]; /*the smallest class able to hold 2^n bytes*/
+        uint8_t NumberOfPools;
+    }_qMallocClasses_t;
+    static _qMallocClasses_t _qMallocClasses_ = {{NULL}, {0}, 0u};
+#endif
+#ifdef Q_TIMER_SERVICE
+    #define _qTimerWheel_Slots  (1u<<Q_TIMERWHEEL_BITS)
+    #define _qTimerWheel_Mask   (_qTimerWheel_Slots - 1u)
+    #define _qTimerWheel_Span   ((qClock_t)1u<<(Q_TIMERWHEEL_BITS*Q_TIMERWHEEL_LEVELS))
+    #define _qTimerWheel_HalfRange  ((qClock_t)(~(qClock_t)0u >> 1)) /*time-epochs differences above this value are considered negative*/
+    typedef struct{
+        qCBTimer_t *Slots[Q_TIMERWHEEL_LEVELS][_qTimerWheel_Slots]; /*the slot lists of every level*/
+        qClock_t Now; /*the last time-epoch processed by the service*/
+        qTask_t *Task; /*the timer service task*/
+        uint32_t Armed; /*number of active timers*/
+    }_qTimerWheel_t;
+    static _qTimerWheel_t _qTimerWheel_;
+#endif
 /*========================= QuarkTS Private Methods===========================*/
 static qTaskState_t _qScheduler_Dispatch(qTask_t *Task, qTrigger_t Event);
 static qTask_t* _qScheduler_GetNodeFromChain(void);
@@ -69,16 +116,146 @@ static void _qScheduler_FindPlace(qTask_t *head, qTask_t *Task);
 static qBool_t _qScheduler_ReadyTasksAvailable(void);
 static qTask_t* _qScheduler_PriorityQueueGet(void);
 static void _qTriggerReleaseSchedEvent(void);
+static void _qScheduler_DiscardTaskEvents(qTask_t *Task);
+#ifdef Q_TASK_GROUPS
+    static void _qTaskGroup_MemberCompleted(qTask_t *Task);
+#endif
+#ifdef Q_PRIORITY_QUEUE
+    static qBool_t _qScheduler_PriorityQueueInsert(qTask_t *Task, void *Data, const qBool_t IsMessage);
+    static void _qScheduler_PriorityQueueCleanup(const qTask_t *Task);
+#endif
+#ifdef Q_MESSAGES
+    typedef struct{ /*reference-counted message header, placed right before the payload*/
+        qMemoryPool_t *Pool; /*the owner pool*/
+        volatile uint32_t RefCount;
+    }_qMessage_t;
+    static void* _qTask_SetAsyncData(qTask_t *Task, void *Data, const qBool_t IsMessage);
+    static uint32_t _qMessage_RefAdd(volatile uint32_t *RefCount, const uint32_t Delta);
+    #define _qMessage_FromPtr(_P_)      ((_qMessage_t*)((uint8_t*)(_P_) - sizeof(_qMessage_t)))
+#endif
+#ifdef Q_MEMORY_MANAGER
+    static void _qTaskPool_Release(qTask_t *Task);
+#endif
+#ifdef Q_SCHEDULER_STATS
+    static void _qScheduler_StatsAccount(const qBool_t Busy);
+#endif
+#ifdef Q_IDLE_WORK
+    static void _qScheduler_IdleWorkRun(void);
+#endif
+#ifdef Q_DEFERRED_CALLS
+    static void _qScheduler_DeferredCallsRun(void);
+#endif
+#if !defined(_qAtomic_LockFree)
+    static qBool_t _qAtomic_CASFallback(volatile uint32_t *Ptr, uint32_t *Expected, const uint32_t Desired);
+#endif
+#ifdef Q_TIMER_SERVICE
+    static void _qCBTimer_Insert(qCBTimer_t *Timer);
+    static void _qCBTimer_Unlink(qCBTimer_t *Timer);
+    static void _qCBTimer_Cascade(const uint8_t Level);
+    static void _qCBTimer_ServiceTask(qEvent_t e);
+#endif
+#ifdef Q_FD_EVENTS
+    static qTrigger_t _qCheckFdEvents(qTask_t *Task);
+    static void _qScheduler_FdWait(const qBool_t Block);
+    static int _qScheduler_FdWaitTimeout(void);
+    #define _qFD_WAIT_MAX_MS            (60000) /*the longest single wait, the next time-event is computed again after it*/
+    #define _qScheduler_Notify()        ((QUARKTS.FdWakeup >= 0)? qSchedulerWakeup() : (void)0) /*only when file descriptors are linked, the scheduler never blocks otherwise*/
+#else
+    #define _qScheduler_Notify()        ((void)0)
+#endif
 static uint8_t __q_revuta(uint32_t num, char* str, uint8_t base);
 static void qStatemachine_ExecSubStateIfAvailable(qSM_SubState_t substate, qSM_t* obj);
 
 #ifdef Q_RINGBUFFERS 
     static qTrigger_t _qCheckRBufferEvents(qTask_t *Task);
     static qSize_t _qRBufferValidPowerOfTwo(qSize_t k);
-    static qSize_t _qRBufferCount(qRBuffer_t *obj);
+    static qRBIndex_t _qRBufferDistance(const qRBuffer_t *obj, const qRBIndex_t head, const qRBIndex_t tail);
+    static qRBIndex_t _qRBufferAdvance(const qRBuffer_t *obj, const qRBIndex_t i, const qRBIndex_t n);
+    static qRBIndex_t _qRBufferCount(qRBuffer_t *obj);
     static qBool_t _qRBufferFull(qRBuffer_t *obj);
+    static void* _qRBufferFront(qRBuffer_t *obj, qRBIndex_t *Tail);
+    static void _qRBufferDropFront(qRBuffer_t *obj, const qRBIndex_t Tail);
+    #define _qRBufferSlot(_OBJ_, _I_)   (((_I_) >= (_OBJ_)->Elementcount)? (qRBIndex_t)((_I_) - (_OBJ_)->Elementcount) : (_I_)) /*the slot of a SPSC index*/
+    #ifdef Q_RBUFFER_32BIT_INDEX
+        #define _qRBIndexMaxCount           (0x7FFFFFFFul)
+        #define _qRBIndexDiff(_A_, _B_)     ((int32_t)(qRBIndex_t)((_A_) - (_B_)))
+    #else
+        #define _qRBIndexMaxCount           (0x7FFFu)
+        #define _qRBIndexDiff(_A_, _B_)     ((int16_t)(qRBIndex_t)((_A_) - (_B_)))
+    #endif
+    #ifdef Q_RBUFFER_MPMC
+        static void* _qRBufferClaimFront(qRBuffer_t *obj, qRBIndex_t *Pos);
+        static void _qRBufferReleaseFront(qRBuffer_t *obj, const qRBIndex_t Pos);
+        static qBool_t _qRBufferPushMPMC(qRBuffer_t *obj, const void *data);
+        #define _qRBufferIsMPMC(_OBJ_)      (NULL != (_OBJ_)->Sequences)
+    #else
+        #define _qRBufferIsMPMC(_OBJ_)      (qFalse)
+    #endif
+    #if defined(Q_RBUFFER_MPMC) || defined(Q_RBUFFER_OVERWRITE)
+        static qBool_t _qRBufferCASIndex(volatile qRBIndex_t *Ptr, qRBIndex_t *Expected, const qRBIndex_t Desired);
+    #endif
+    #ifdef Q_RBUFFER_OVERWRITE
+        #define _qRBufferIsOverwrite(_OBJ_) ((_OBJ_)->Overwrite)
+    #else
+        #define _qRBufferIsOverwrite(_OBJ_) (qFalse)
+    #endif
+    #define _qRBufferIsShared(_OBJ_)        (_qRBufferIsMPMC(_OBJ_) || _qRBufferIsOverwrite(_OBJ_)) /*the indices are moved by both sides, the bulk and in-place calls are not allowed*/
 #endif
 
+#ifdef Q_MEMORY_MANAGER
+    static void _qMemoryFreeListPush(qMemoryPool_t *obj, const uint16_t Index);
+    static void _qMemoryFreeListUnlink(qMemoryPool_t *obj, const uint16_t Index);
+    static uint16_t _qMemoryFindRun(qMemoryPool_t *obj, const uint16_t nBlocks);
+    static void _qMemoryMapUpdate(qMemoryPool_t *obj, uint16_t Index, uint16_t nBlocks, const qBool_t Free);
+    static uint8_t _qMemory_clz(uint32_t x);
+    static uint8_t _qMemory_ctz(uint32_t x);
+    #define _qMemBlock(_POOL_, _INDEX_)             ((_POOL_)->Blocks + (uint32_t)(_INDEX_)*(_POOL_)->BlockSize)
+    #define _qMemLinkNext(_POOL_, _INDEX_)          (((uint16_t*)_qMemBlock(_POOL_, _INDEX_))[0]) /*the free-list links are stored in the first bytes of the free blocks*/
+    #define _qMemLinkPrev(_POOL_, _INDEX_)          (((uint16_t*)_qMemBlock(_POOL_, _INDEX_))[1])
+    #define _qMemMapSet(_POOL_, _INDEX_)            ((_POOL_)->FreeMap[(_INDEX_)>>5] |= (uint32_t)1ul << ((_INDEX_) & 31u))
+    #define _qMemMapClear(_POOL_, _INDEX_)          ((_POOL_)->FreeMap[(_INDEX_)>>5] &= ~((uint32_t)1ul << ((_INDEX_) & 31u)))
+    #ifdef Q_MEMORY_STATS
+        static void _qMemoryStatsAlloc(qMemoryPool_t *obj, const qSize_t size, const uint16_t nBlocks);
+        #define _qMemoryStatsFree(_POOL_, _NBLOCKS_)    if(0u != (_NBLOCKS_)){ (_POOL_)->Stats.BlocksInUse -= (_NBLOCKS_); (_POOL_)->Stats.Frees++; }
+    #else
+        #define _qMemoryStatsAlloc(_POOL_, _SIZE_, _NBLOCKS_)
+        #define _qMemoryStatsFree(_POOL_, _NBLOCKS_)
+    #endif
+#endif
+#ifdef Q_TLSF_HEAP
+    typedef struct _qTLSFBlock_t{ /*TLSF block header*/
+        struct _qTLSFBlock_t *PrevPhys; /*the previous physical block (only valid if it is free, it is stored in the last word of its payload)*/
+        size_t Size; /*the payload size, the two LSBs are the flags : bit0 = free, bit1 = previous block free*/
+        struct _qTLSFBlock_t *NextFree, *PrevFree; /*the free list links (only valid if the block is free, stored in the payload)*/
+    }_qTLSFBlock_t;
+    static uint8_t _qTLSF_fls(uint32_t x);
+    static uint8_t _qTLSF_ffs(uint32_t x);
+    static void _qTLSF_Mapping(size_t size, uint8_t *fl, uint8_t *sl);
+    static _qTLSFBlock_t* _qTLSF_SearchSuitable(qTLSFHeap_t *Heap, uint8_t *fl, uint8_t *sl);
+    static void _qTLSF_RemoveFree(qTLSFHeap_t *Heap, _qTLSFBlock_t *Block, const uint8_t fl, const uint8_t sl);
+    static void _qTLSF_InsertFree(qTLSFHeap_t *Heap, _qTLSFBlock_t *Block);
+    static void _qTLSF_Remove(qTLSFHeap_t *Heap, _qTLSFBlock_t *Block);
+    static _qTLSFBlock_t* _qTLSF_LinkNext(_qTLSFBlock_t *Block);
+    static void _qTLSF_MarkAsFree(_qTLSFBlock_t *Block);
+    static _qTLSFBlock_t* _qTLSF_Absorb(_qTLSFBlock_t *Prev, _qTLSFBlock_t *Block);
+    #define _qTLSF_FREE_BIT             ((size_t)1u)
+    #define _qTLSF_PREVFREE_BIT         ((size_t)2u)
+    #define _qTLSF_ALIGN                ((size_t)1u << _qTLSF_ALIGN_LOG2)
+    #define _qTLSF_OVERHEAD             (sizeof(size_t)) /*only the size field is kept in the used blocks*/
+    #define _qTLSF_START_OFFSET         (sizeof(_qTLSFBlock_t*) + sizeof(size_t)) /*from the header to the payload*/
+    #define _qTLSF_BLOCK_SIZE_MIN       (sizeof(_qTLSFBlock_t) - sizeof(_qTLSFBlock_t*)) /*the payload must hold the free list links and the next PrevPhys*/
+    #define _qTLSF_BLOCK_SIZE_MAX       ((size_t)1u << Q_TLSF_FL_INDEX_MAX)
+    #define _qTLSF_SMALL_BLOCK_SIZE     ((size_t)1u << _qTLSF_FL_SHIFT)
+    #define _qTLSF_Size(_B_)            ((_B_)->Size & ~(_qTLSF_FREE_BIT | _qTLSF_PREVFREE_BIT))
+    #define _qTLSF_SetSize(_B_, _S_)    ((_B_)->Size = (_S_) | ((_B_)->Size & (_qTLSF_FREE_BIT | _qTLSF_PREVFREE_BIT)))
+    #define _qTLSF_IsFree(_B_)          (0u != ((_B_)->Size & _qTLSF_FREE_BIT))
+    #define _qTLSF_IsPrevFree(_B_)      (0u != ((_B_)->Size & _qTLSF_PREVFREE_BIT))
+    #define _qTLSF_ToPtr(_B_)           ((void*)((uint8_t*)(_B_) + _qTLSF_START_OFFSET))
+    #define _qTLSF_FromPtr(_P_)         ((_qTLSFBlock_t*)((uint8_t*)(_P_) - _qTLSF_START_OFFSET))
+    #define _qTLSF_Next(_B_)            ((_qTLSFBlock_t*)((uint8_t*)_qTLSF_ToPtr(_B_) + _qTLSF_Size(_B_) - _qTLSF_OVERHEAD))
+    #define _qTLSF_AlignUp(_X_)         (((_X_) + (_qTLSF_ALIGN - 1u)) & ~(_qTLSF_ALIGN - 1u))
+    #define _qTLSF_AlignDown(_X_)       ((_X_) & ~(_qTLSF_ALIGN - 1u))
+#endif
 static char qNibbletoX(uint8_t value);    
 qPutChar_t __qDebugOutputFcn = NULL;
 #ifdef Q_TRACE_VARIABLES
@@ -93,8 +270,26 @@ qPutChar_t __qDebugOutputFcn = NULL;
 #define __qFSMCallbackMode      ((qTaskFcn_t)1)
 #define _qTaskDeadlineReached(_TASK_)            ( (qTimeInmediate == (_TASK_)->Interval) || ((_qSysTick_Epochs_ - (_TASK_)->ClockStart)>=(_TASK_)->Interval)  )
 #define _qTaskHasPendingIterations(_TASK_)       (_qabs((_TASK_)->Iterations)>0 || qPeriodic == (_TASK_)->Iterations)
+#define _qTaskIsPooled(_TASK_)                   ( (NULL != QUARKTS.TaskPool) && ((uint8_t*)(_TASK_) >= QUARKTS.TaskPool->Blocks) && ((uint8_t*)(_TASK_) < (QUARKTS.TaskPool->Blocks + (uint32_t)QUARKTS.TaskPool->NumberofBlocks*QUARKTS.TaskPool->BlockSize)) )
+#define _qTaskPoolIndex(_TASK_)                  ( (uint16_t)(((uint8_t*)(_TASK_) - QUARKTS.TaskPool->Blocks)/QUARKTS.TaskPool->BlockSize) )
+#define _qCRParkExpired(_PARK_)                  ((_qSysTick_Epochs_ - (_PARK_)->ClockStart)>=(_PARK_)->Interval)
+#define _qCRPark_None                            0u
+#define _qCRPark_Active                          1u
+#define _qCRPark_Timeout                         2u
 #define _qEvent_FillCommonFields(_eVar_, _Trigger_, _FirstCall_, _TaskData_)    (_eVar_).Trigger = _Trigger_; (_eVar_).FirstCall = _FirstCall_; (_eVar_).TaskData = _TaskData_
 
+#if defined(_qAtomic_LockFree) /*lock-free primitives*/
+    #define _qAtomic_Load(_PTR_)                    __atomic_load_n((_PTR_), __ATOMIC_ACQUIRE)
+    #define _qAtomic_Store(_PTR_, _VAL_)            __atomic_store_n((_PTR_), (_VAL_), __ATOMIC_RELEASE)
+    #define _qAtomic_CAS(_PTR_, _EXP_, _VAL_)       __atomic_compare_exchange_n((_PTR_), (_EXP_), (_VAL_), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+    #define _qAtomic_Fence()                        __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else /*no atomics available, fallback to the critical sections (see qSchedulerSetInterruptsED)*/
+    #define _qAtomic_Load(_PTR_)                    (*(_PTR_))
+    #define _qAtomic_Store(_PTR_, _VAL_)            (*(_PTR_) = (_VAL_))
+    #define _qAtomic_CAS(_PTR_, _EXP_, _VAL_)       _qAtomic_CASFallback((_PTR_), (_EXP_), (_VAL_))
+    #define _qAtomic_Fence()                        ((void)0)
+#endif
+
 #define qSchedulerStartPoint                    QUARKTS.Flag.Init=qTrue; do
 #define qSchedulerEndPoint                      while(!QUARKTS.Flag.ReleaseSched); _qTriggerReleaseSchedEvent()
 
@@ -175,6 +370,99 @@ Parameters:
 void qSchedulerSetIdleTask(qTaskFcn_t Callback){
     QUARKTS.IDLECallback = Callback;
 }
+#ifdef Q_SCHEDULER_STATS
+/*============================================================================*/
+/*qBool_t qSchedulerSetStatsWindow(qTime_t Window)
+
+Set the time window used to estimate the CPU load.
+
+Parameters:
+
+    - Window : The window length in seconds (floating-point format).
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse (the window is shorter 
+    than one tick).
+*/
+qBool_t qSchedulerSetStatsWindow(const qTime_t Window){
+    qClock_t w = qTime2Clock(Window);
+    if(0u == w) return qFalse;
+    QUARKTS.Stats.Window = w;
+    QUARKTS.Stats.WindowIdle = QUARKTS.Stats.WindowBusy = 0u; /*restart the current window*/
+    return qTrue;
+}
+/*============================================================================*/
+/*qBool_t qSchedulerGetStats(qSchedulerStats_t *Stats)
+
+Get a snapshot of the scheduler health statistics.
+
+Parameters:
+
+    - Stats : A pointer to the qSchedulerStats_t structure where the statistics 
+              will be copied.
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse.
+*/
+qBool_t qSchedulerGetStats(qSchedulerStats_t *Stats){
+    if(NULL==Stats) return qFalse;
+    qEnterCritical();
+    *Stats = QUARKTS.Stats;
+    qExitCritical();
+    return qTrue;
+}
+/*============================================================================*/
+/*uint8_t qSchedulerGetCPULoad(void)
+
+Get the CPU load estimate, computed as the ratio of the busy time against the 
+total time in the last completed window (see qSchedulerSetStatsWindow).
+
+Return value:
+
+    The CPU load in percent [0-100].
+*/
+uint8_t qSchedulerGetCPULoad(void){
+    return QUARKTS.Stats.CPULoad;
+}
+/*============================================================================*/
+/*void qSchedulerResetStats(void)
+
+Clears the scheduler health statistics. The CPU load window is kept.
+*/
+void qSchedulerResetStats(void){
+    qClock_t w = QUARKTS.Stats.Window;
+    memset((void*)&QUARKTS.Stats, 0, sizeof(qSchedulerStats_t));
+    QUARKTS.Stats.Window = w;
+    QUARKTS.Stats.LastEpoch = _qSysTick_Epochs_;
+}
+/*============================================================================*/
+static void _qScheduler_StatsAccount(const qBool_t Busy){ /*the elapsed epochs since the last accounting point are attributed to the current activity*/
+    qClock_t now = _qSysTick_Epochs_, elapsed, total, busy;
+    elapsed = now - QUARKTS.Stats.LastEpoch;
+    if(0u == elapsed) return; /*the cost is a single comparison while the tick doesn't change*/
+    QUARKTS.Stats.LastEpoch = now;
+    if(Busy){
+        QUARKTS.Stats.BusyEpochs += elapsed;
+        QUARKTS.Stats.WindowBusy += elapsed;
+    }
+    else{
+        QUARKTS.Stats.IdleEpochs += elapsed;
+        QUARKTS.Stats.WindowIdle += elapsed;        
+    }
+    total = QUARKTS.Stats.WindowBusy + QUARKTS.Stats.WindowIdle;
+    if(total >= QUARKTS.Stats.Window){ /*window completed, update the load estimate*/
+        busy = QUARKTS.Stats.WindowBusy;
+        while(total > (0xFFFFFFFFul/100u)){ /*scale down both operands, so busy*100 can't overflow on long windows*/
+            busy >>= 1;
+            total >>= 1;
+        }
+        QUARKTS.Stats.CPULoad = (uint8_t)((busy*100u)/total);
+        QUARKTS.Stats.WindowBusy = QUARKTS.Stats.WindowIdle = 0u;
+    }
+}
+#endif
 /*============================================================================*/
 /*void qSchedulerRelease(void)
 
@@ -229,8 +517,13 @@ Parameters:
 */ 
 void qTaskSendEvent(qTask_t *Task, void* eventdata){
     if(NULL==Task) return;
+    #ifdef Q_MESSAGES
+    qMessageRelease(_qTask_SetAsyncData(Task, eventdata, qFalse)); /*a pending message replaced by this event will not be delivered*/
+    #else
     Task->Flag[_qIndex_AsyncRun] = qTrue;
     Task->AsyncData = eventdata;
+    #endif
+    _qScheduler_Notify();
 }
 /*============================================================================*/
 /*void qTaskSetTime(qTask_t *Task, qTime_t Value)
@@ -343,6 +636,85 @@ void qTaskClearTimeElapsed(qTask_t *Task){
     Task->ClockStart = _qSysTick_Epochs_;
 }
 /*============================================================================*/
+/*_qTaskPC_t* _qCRTaskPCGet(void)
+
+Get the storage of the Coroutine progress for the current running task.
+Used internally by qCoroutineTaskBegin.
+
+Return value:
+
+    A pointer to the Coroutine progress of the current running task. If no task
+    is running (i.e. the idle task), a pointer to a dedicated storage is returned.
+*/
+_qTaskPC_t* _qCRTaskPCGet(void){
+    qTask_t *Task = QUARKTS.CurrentRunningTask;
+    if(NULL==Task) return &_qCRIdleTaskState_;
+    return (_qTaskPC_t*)&Task->CRState;
+}
+/*============================================================================*/
+/*void _qCRParkTask(const qTime_t Time)
+
+Parks the current running task inside the scheduler for the specified time. 
+While parked, the task will not be dispatched by time-elapsed events, and it 
+will be woken up by the scheduler exactly when the time expires. The idle task
+is not handled by the scheduler, so it only keeps its own parking registers and
+polls them each time it runs.
+Used internally by qCoroutineDelay and qCoroutineWaitUntilTimeout.
+
+Parameters:
+
+    - Time : The parking time (Must be specified in seconds).
+*/
+void _qCRParkTask(const qTime_t Time){
+    qTask_t *Task = QUARKTS.CurrentRunningTask;
+    volatile _qCRPark_t *Park = (NULL==Task)? &_qCRIdleTaskPark_ : &Task->CRPark;
+    Park->Interval = qTime2Clock(Time);
+    Park->ClockStart = _qSysTick_Epochs_;
+    Park->State = _qCRPark_Active;
+}
+/*============================================================================*/
+/*qBool_t _qCRParkRelease(const qBool_t Condition)
+
+Checks if the current running task can leave the parking state. The task gets
+unparked if the condition is true or if the parking time expires.
+Used internally by qCoroutineDelay and qCoroutineWaitUntilTimeout.
+
+Parameters:
+
+    - Condition : The logical condition to release the task.
+
+Return value:
+
+    Returns qTrue if the task was unparked, otherwise returns qFalse.
+*/
+qBool_t _qCRParkRelease(const qBool_t Condition){
+    qTask_t *Task = QUARKTS.CurrentRunningTask;
+    volatile _qCRPark_t *Park = (NULL==Task)? &_qCRIdleTaskPark_ : &Task->CRPark;
+    if(Condition){
+        Park->State = _qCRPark_None;
+    }
+    else if(_qCRParkExpired(Park)){
+        Park->State = _qCRPark_Timeout;
+    }
+    else return qFalse; /*keep the task parked*/
+    if(NULL != Task) Task->ClockStart = _qSysTick_Epochs_; /*restart the task time, so the periodic timing resumes from here*/
+    return qTrue;
+}
+/*============================================================================*/
+/*qBool_t _qCRParkTimeoutExpired(void)
+
+Checks if the last parking of the current running task was released by timeout.
+Used internally by qCoroutineTimeoutExpired.
+
+Return value:
+
+    Returns qTrue if the timeout expired, otherwise returns qFalse.
+*/
+qBool_t _qCRParkTimeoutExpired(void){
+    qTask_t *Task = QUARKTS.CurrentRunningTask;
+    return (qBool_t)(_qCRPark_Timeout == ((NULL==Task)? _qCRIdleTaskPark_.State : Task->CRPark.State));
+}
+/*============================================================================*/
 /*qBool_t qTaskQueueEvent(const qTask_t *Task, void* eventdata)
 
 Insert an asynchronous event in the FIFO priority queue. The task will be ready
@@ -363,12 +735,7 @@ Return value:
 */
 qBool_t qTaskQueueEvent(qTask_t *Task, void* eventdata){
     #ifdef Q_PRIORITY_QUEUE
-        volatile qQueueStack_t tmp;
-        if((NULL==Task) || (QUARKTS.QueueIndex>=QUARKTS.QueueSize-1) ) return qFalse;    /*check if data can be queued*/
-        tmp.QueueData = eventdata;
-        tmp.Task = Task;
-        QUARKTS.QueueStack[++QUARKTS.QueueIndex] = tmp; /*insert task and the corresponding eventdata to the queue*/
-    return qTrue;
+        return _qScheduler_PriorityQueueInsert(Task, eventdata, qFalse);
     #else
         return qFalse;
     #endif
@@ -392,6 +759,21 @@ void qSchedulerSetInterruptsED(void (*Restorer)(uint32_t), uint32_t (*Disabler)(
 }
 #ifdef Q_PRIORITY_QUEUE
 /*============================================================================*/
+static qBool_t _qScheduler_PriorityQueueInsert(qTask_t *Task, void *Data, const qBool_t IsMessage){
+    volatile qQueueStack_t tmp;
+    if((NULL==Task) || (QUARKTS.QueueIndex>=QUARKTS.QueueSize-1) ) return qFalse;    /*check if data can be queued*/
+    tmp.QueueData = Data;
+    tmp.Task = Task;
+    #ifdef Q_MESSAGES
+    tmp.IsMessage = IsMessage;
+    #else
+    (void)IsMessage;
+    #endif
+    QUARKTS.QueueStack[++QUARKTS.QueueIndex] = tmp; /*insert task and the corresponding eventdata to the queue*/
+    _qScheduler_Notify();
+    return qTrue;
+}
+/*============================================================================*/
 static qTask_t* _qScheduler_PriorityQueueGet(void){
     qTask_t *Task = NULL;
     uint8_t i;
@@ -408,6 +790,9 @@ static qTask_t* _qScheduler_PriorityQueueGet(void){
         }
     }   
     QUARKTS.QueueData = QUARKTS.QueueStack[IndexTaskToExtract].QueueData; /*get the data from the queue*/
+    #ifdef Q_MESSAGES
+    QUARKTS.QueueMessage = QUARKTS.QueueStack[IndexTaskToExtract].IsMessage;
+    #endif
     Task = QUARKTS.QueueStack[IndexTaskToExtract].Task; /*assign the task to the output*/
     Task->State = qReady; /*set the task as ready*/
     QUARKTS.QueueStack[IndexTaskToExtract].Task = NULL; /*set the position in the queue as empty*/  
@@ -416,6 +801,33 @@ static qTask_t* _qScheduler_PriorityQueueGet(void){
     qExitCritical();
     return Task;
 }
+/*============================================================================*/
+static void _qScheduler_PriorityQueueCleanup(const qTask_t *Task){ /*remove all the queued events of the task*/
+    int16_t i, j = 0;
+    #ifdef Q_MESSAGES
+    void *PendingMsg;
+    do{ /*drop the references of the queued messages, one at a time (the release can't be done inside the critical section)*/
+        PendingMsg = NULL;
+        qEnterCritical();
+        for(i=0; i<=QUARKTS.QueueIndex; i++){
+            if(QUARKTS.QueueStack[i].Task == Task && QUARKTS.QueueStack[i].IsMessage){
+                QUARKTS.QueueStack[i].IsMessage = qFalse;
+                PendingMsg = QUARKTS.QueueStack[i].QueueData;
+                break;
+            }
+        }
+        qExitCritical();
+        qMessageRelease(PendingMsg);
+    }while(NULL != PendingMsg);
+    #endif
+    qEnterCritical();
+    for(i=0; i<=QUARKTS.QueueIndex; i++){
+        if(QUARKTS.QueueStack[i].Task != Task) QUARKTS.QueueStack[j++] = QUARKTS.QueueStack[i]; /*keep the events of the other tasks*/
+    }
+    for(i=j; i<=QUARKTS.QueueIndex; i++) QUARKTS.QueueStack[i].Task = NULL; /*set the positions in the queue as empty*/
+    QUARKTS.QueueIndex = (int16_t)(j - 1);
+    qExitCritical();
+}
 #endif
 /*============================================================================*/
 void _qInitScheduler(const qTime_t ISRTick, qTaskFcn_t IdleCallback, volatile qQueueStack_t *Q_Stack, const uint8_t Size_Q_Stack){
@@ -430,6 +842,9 @@ void _qInitScheduler(const qTime_t ISRTick, qTaskFcn_t IdleCallback, volatile qQ
         for(i=0;i<QUARKTS.QueueSize;i++) QUARKTS.QueueStack[i].Task = NULL;  /*set the priority queue as empty*/  
         QUARKTS.QueueIndex = -1;     
         QUARKTS.QueueData = NULL;
+        #ifdef Q_MESSAGES
+        QUARKTS.QueueMessage = qFalse;
+        #endif
     #endif
     QUARKTS.Flag.Init = qFalse;
     QUARKTS.Flag.ReleaseSched = qFalse;
@@ -437,6 +852,31 @@ void _qInitScheduler(const qTime_t ISRTick, qTaskFcn_t IdleCallback, volatile qQ
     QUARKTS.I_Restorer =  NULL;
     QUARKTS.I_Disable = NULL;
     QUARKTS.CurrentRunningTask = NULL;
+    QUARKTS.ChainIterator = __qChainInitializer;
+    #ifdef Q_IDLE_WORK
+        QUARKTS.IdleWorkHead = QUARKTS.IdleWorkTail = NULL;
+        QUARKTS.IdleWorkRunning = NULL;
+        QUARKTS.IdleWorkResubmit = qFalse;
+    #endif
+    #ifdef Q_DEFERRED_CALLS
+        QUARKTS.DeferredCalls = NULL;
+        QUARKTS.DeferredMask = 0u;
+        QUARKTS.DeferredEnqueue = QUARKTS.DeferredDequeue = 0u;
+    #endif
+    #ifdef Q_SCHEDULER_STATS
+        qSchedulerResetStats();
+        QUARKTS.Stats.Window = qTime2Clock(Q_CPULOAD_DEFAULT_WINDOW);
+    #endif
+    #ifdef Q_MEMORY_MANAGER
+        QUARKTS.TaskPool = NULL;
+        QUARKTS.TaskToReclaim = NULL;
+    #endif
+    #ifdef Q_FD_EVENTS
+        QUARKTS.FdPoller = -1; /*the epoll instance is created when the first file descriptor gets linked*/
+        QUARKTS.FdWakeup = -1;
+        QUARKTS.FdBlock = qFalse;
+        QUARKTS.FdSleeping = qFalse;
+    #endif
     _qSysTick_Epochs_ = 0ul;
 }
 /*============================================================================*/
@@ -486,12 +926,24 @@ qBool_t qSchedulerAddxTask(qTask_t *Task, qTaskFcn_t CallbackFcn, qPriority_t Pr
     Task->Flag[_qIndex_RBCount] = qFalse;
     Task->Flag[_qIndex_RBEmpty] = qFalse;
     Task->Flag[_qIndex_Enabled] = (qBool_t)(InitialState != qFalse);
+    Task->CRPark.State = _qCRPark_None;
+    Task->Flag[_qIndex_GroupPending] = qFalse;
+    Task->Flag[_qIndex_AsyncMsg] = qFalse;
+    Task->CRState = qCR_PCInitVal;
     Task->Next = NULL;  
     Task->Cycles = 0;
     Task->ClockStart = _qSysTick_Epochs_;
     #ifdef Q_RINGBUFFERS
     Task->RingBuff = NULL;
     #endif
+    #ifdef Q_TASK_GROUPS
+    Task->Group = NULL;
+    Task->GroupIndex = 0u;
+    #endif
+    #ifdef Q_FD_EVENTS
+    Task->Fd = -1;
+    Task->FdEvents = 0u;
+    #endif
     Task->StateMachine = NULL;
     Task->State = qSuspended;
     QUARKTS.Head =  _qScheduler_PriorizedInsert( QUARKTS.Head, Task ); /*put the task on the list according to its priority*/
@@ -579,7 +1031,8 @@ qBool_t qSchedulerAddSMTask(qTask_t *Task, qPriority_t Priority, qTime_t Time,
 /*============================================================================*/
 /*qBool_t qSchedulerRemoveTask(qTask_t *Task)
 
-Remove the task from the scheduling scheme.
+Remove the task from the scheduling scheme. The pending events of the task 
+are discarded (the references of the undelivered messages are dropped).
 
 Parameters:
 
@@ -600,12 +1053,129 @@ qBool_t qSchedulerRemoveTask(qTask_t *Task){
     if(tmp == Task){ /*remove the task if was found on the chain*/
         if(prev) prev->Next = tmp->Next; /*make link between adjacent nodes, this cause that the task being removed from the chain*/
         else QUARKTS.Head = tmp->Next; /*if the task is the head of the chain, move the head to the next node*/
+        if(QUARKTS.ChainIterator == Task) QUARKTS.ChainIterator = Task->Next; /*the scheduler was about to visit this task, so skip it. This makes the removal safe during the chain iteration*/
+        #ifdef Q_FD_EVENTS
+        if(Task->Fd >= 0) qTaskLinkFd(Task, Task->Fd, qFD_READWRITE, qUnLink); /*the task can't be triggered anymore by its file descriptor*/
+        #endif
+        #ifdef Q_TASK_GROUPS
+        if(NULL != Task->Group){
+            if(Task->Flag[_qIndex_GroupPending]) _qTaskGroup_MemberCompleted(Task); /*the fork can't wait for a removed member*/
+            Task->Group = NULL; /*leave the group*/
+        }
+        #endif
+        _qScheduler_DiscardTaskEvents(Task);
         Task->Next = NULL; /*Just in case the deleted task needs to be added later to the scheduling scheme, otherwise, this would fuck the whole chain*/
         return qTrue;
     }
     return qFalse;
 }
 /*============================================================================*/
+static void _qScheduler_DiscardTaskEvents(qTask_t *Task){ /*the removed task can't be referenced anymore by its pending events*/
+    #ifdef Q_PRIORITY_QUEUE
+    _qScheduler_PriorityQueueCleanup(Task);
+    #endif
+    #ifdef Q_MESSAGES
+    qMessageRelease(_qTask_SetAsyncData(Task, NULL, qFalse)); /*drop the reference of the undelivered message*/
+    #endif
+    Task->Flag[_qIndex_AsyncRun] = qFalse;
+}
+#ifdef Q_MEMORY_MANAGER
+/*============================================================================*/
+void _qInitTaskPool(qMemoryPool_t *Pool, qTask_t *Area, uint16_t *Descriptors, uint32_t *FreeMap, const uint16_t Size){
+    if(NULL==Pool || NULL==Area || NULL==Descriptors || NULL==FreeMap || 0u==Size) return;
+    Pool->BlockSize = (qSize_t)sizeof(qTask_t); /*one block per task node*/
+    Pool->NumberofBlocks = Size;
+    Pool->BlockDescriptors = Descriptors;
+    Pool->FreeMap = FreeMap;
+    Pool->Blocks = (uint8_t*)Area;
+    _qMemoryPoolInit(Pool);
+    QUARKTS.TaskPool = Pool;
+    QUARKTS.TaskToReclaim = NULL;
+}
+/*============================================================================*/
+/*qMemoryPool_t* qSchedulerGetTaskPool(void)
+
+Retrieve the memory pool that holds the task nodes used by qTaskCreate 
+(see qSchedulerSetupTaskPool). Can be used to inspect the usage of the 
+task pool with qMemoryGetStats.
+
+Return value:
+
+    A pointer to the task pool, or NULL if the task pool was not created.
+*/
+qMemoryPool_t* qSchedulerGetTaskPool(void){
+    return QUARKTS.TaskPool;
+}
+/*============================================================================*/
+/*qTask_t* qTaskCreate(qTaskFcn_t CallbackFcn, qPriority_t Priority, qTime_t Time, qIteration_t nExecutions, qState_t InitialState, void* arg)
+
+Takes a task node from the task pool (see qSchedulerSetupTaskPool) and adds it 
+to the scheduling scheme. Same as qSchedulerAddxTask, but the task node is 
+dynamically allocated from the task pool in constant time and without 
+fragmentation (one memory block per task node).
+When the task performs all its iterations, the task node is automatically 
+returned to the pool (any other pending event for that task is discarded). If 
+the task Coroutine is parked (qCoroutineDelay or qCoroutineWaitUntilTimeout), 
+the node is returned after the dispatch that leaves the parking.
+
+Parameters:
+    - CallbackFcn : A pointer to a void callback method with a qEvent_t parameter 
+                 as input argument.
+    - Priority : Task priority Value. [0(min) - 255(max)]
+    - Time : Execution interval defined in seconds (floating-point format). 
+               For immediate execution (tValue = qTimeInmediate).
+    - nExecutions : Number of task executions (Integer value). For indefinite 
+               execution (nExecutions = qPeriodic or qIndefinite).
+    - InitialState : Specifies the initial state of the task (qEnabled or qDisabled).
+    - arg : Represents the task arguments.
+
+Return value:
+
+    A pointer to the created task node, or NULL if the task pool is exhausted.
+*/
+qTask_t* qTaskCreate(qTaskFcn_t CallbackFcn, qPriority_t Priority, qTime_t Time, qIteration_t nExecutions, qState_t InitialState, void* arg){
+    qTask_t *Task;
+    if(NULL==CallbackFcn || NULL==QUARKTS.TaskPool) return NULL;
+    Task = (qTask_t*)qMemoryAlloc(QUARKTS.TaskPool, (qSize_t)sizeof(qTask_t)); /*single-block request : taken from the free-list of the pool*/
+    if(NULL == Task) return NULL; /*the pool is exhausted*/
+    qSchedulerAddxTask(Task, CallbackFcn, Priority, Time, nExecutions, InitialState, arg);
+    return Task;
+}
+/*============================================================================*/
+/*qBool_t qTaskDestroy(qTask_t *Task)
+
+Removes the task from the scheduling scheme and returns its node to the task pool.
+This API is safe to be called from any task callback, even to destroy the 
+current running task.
+
+Parameters:
+
+    - Task : A pointer to the task node obtained with qTaskCreate.
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse (i.e. the task was not 
+    created with qTaskCreate or it was already destroyed).
+*/
+qBool_t qTaskDestroy(qTask_t *Task){
+    if(NULL==Task) return qFalse;
+    if(!_qTaskIsPooled(Task)) return qFalse;
+    if(0u == QUARKTS.TaskPool->BlockDescriptors[_qTaskPoolIndex(Task)] || QUARKTS.TaskToReclaim == Task) return qFalse; /*the node is not allocated*/
+    if(Task == QUARKTS.CurrentRunningTask){
+        qSchedulerRemoveTask(Task);
+        QUARKTS.TaskToReclaim = Task; /*the dispatcher is still using this node, release it after the dispatch*/
+    }
+    else _qTaskPool_Release(Task);
+    return qTrue;
+}
+/*============================================================================*/
+static void _qTaskPool_Release(qTask_t *Task){
+    if(!qSchedulerRemoveTask(Task)) _qScheduler_DiscardTaskEvents(Task); /*already removed (destroyed while running), drop the events sent after its removal*/
+    Task->Flag[_qIndex_Enabled] = qFalse;
+    qMemoryFree(QUARKTS.TaskPool, (void*)Task); /*return the node to the task pool*/
+}
+#endif
+/*============================================================================*/
 static qTask_t* _qScheduler_PriorizedInsert(qTask_t *head, qTask_t *Task){ /*return the new head if modified*/
     if( (NULL == head ) || (Task->Priority > head->Priority) ){ /*Is the first task in the scheme or the task has the highest priority over all */
         Task->Next = head; /*move the head and just add the task node on top*/
@@ -699,85 +1269,711 @@ static qTrigger_t _qCheckRBufferEvents(qTask_t *Task){
     return qTriggerNULL;
 }
 #endif
+#ifdef Q_FD_EVENTS
 /*============================================================================*/
-static void _qTriggerReleaseSchedEvent(void){
-    QUARKTS.Flag.Init = qFalse;
-    QUARKTS.Flag.ReleaseSched = qFalse;   
-    QUARKTS.EventInfo.FirstCall = (qBool_t)(!QUARKTS.Flag.FCallReleased);    
-    QUARKTS.EventInfo.Trigger = bySchedulingRelease;
-    QUARKTS.EventInfo.TaskData = NULL;
-    if(QUARKTS.ReleaseSchedCallback!=NULL) QUARKTS.ReleaseSchedCallback((qEvent_t)&QUARKTS.EventInfo);
-    QUARKTS.Flag.FCallIdle = qTrue;      
-}
-/*============================================================================*/
-/*
-void qSchedulerSysTick(void)
+/*qBool_t qTaskLinkFd(qTask_t *Task, int fd, const qFdLinkMode_t Mode, uint8_t arg)
 
-Feed the scheduler system tick. This call is mandatory and must be called once
-inside the dedicated timer interrupt service routine (ISR). 
-*/    
-void qSchedulerSysTick(void){_qSysTick_Epochs_++;}
+Links the Task with a file descriptor (socket, serial port, pipe, etc...). The 
+scheduler waits for the file descriptor readiness (epoll) when there are no 
+ready tasks, so the task is triggered without any busy polling. The events
+sent from other threads (async, queue, messages and ring-buffer pushes) wake-up
+the blocked scheduler (see qSchedulerWakeup).
+(Linux only)
+
+Parameters:
+
+    - Task : A pointer to the task node.
+    - fd : The file descriptor. Only one file descriptor can be linked to a task.
+    - Mode: Linking mode. This implies the event that will trigger the task according
+            to one of the following modes:
+                        > qFD_READABLE: The task will be triggered with <byFdReadable>
+                          when the file descriptor is ready for reading. 
+                        > qFD_WRITABLE: The task will be triggered with <byFdWritable>
+                          when the file descriptor is ready for writing.
+                        > qFD_READWRITE: Both of the above.
+                        
+                        A pointer to the file descriptor will be available in
+                        the <EventData> field of qEvent_t structure.
+                        Note: The readiness is level-triggered, so the task will be
+                        triggered again if the data is not consumed.
+    - arg: This argument defines if the file descriptor will be linked (qLINK) or 
+           unlinked (qUNLINK) from the task.
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse;
+*/
+qBool_t qTaskLinkFd(qTask_t *Task, int fd, const qFdLinkMode_t Mode, uint8_t arg){
+    struct epoll_event ev;
+    if(NULL==Task || fd<0 || 0u==(Mode & qFD_READWRITE)) return qFalse;  /*Validate*/
+    if(!arg){ /*unlink*/
+        if(fd != Task->Fd) return qFalse;
+        if(QUARKTS.FdPoller >= 0) epoll_ctl(QUARKTS.FdPoller, EPOLL_CTL_DEL, fd, &ev);
+        Task->Fd = -1;
+        Task->FdEvents = 0u;
+        return qTrue;
+    }
+    if(Task->Fd>=0 && Task->Fd!=fd) return qFalse; /*another file descriptor is already linked*/
+    if(QUARKTS.FdPoller < 0){ /*create the epoll instance on the first link*/
+        if((QUARKTS.FdPoller = epoll_create1(EPOLL_CLOEXEC)) < 0) return qFalse;
+        if((QUARKTS.FdWakeup = eventfd(0u, EFD_CLOEXEC | EFD_NONBLOCK)) >= 0){ /*so the events from other threads can wake-up the scheduler*/
+            ev.events = EPOLLIN;
+            ev.data.ptr = NULL; /*tells the wake-up requests from the task events*/
+            if(0 != epoll_ctl(QUARKTS.FdPoller, EPOLL_CTL_ADD, QUARKTS.FdWakeup, &ev)){
+                close(QUARKTS.FdWakeup);
+                QUARKTS.FdWakeup = -1;
+            }
+        }
+    }
+    ev.events = ((Mode & qFD_READABLE)? EPOLLIN : 0u) | ((Mode & qFD_WRITABLE)? EPOLLOUT : 0u);
+    ev.data.ptr = (void*)Task;
+    if(0 != epoll_ctl(QUARKTS.FdPoller, (Task->Fd == fd)? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev)) return qFalse;
+    Task->Fd = fd;
+    Task->FdEvents = 0u;
+    return qTrue;
+}
 /*============================================================================*/
-qClock_t qSchedulerGetTick(void){
-	return _qSysTick_Epochs_;
+static qTrigger_t _qCheckFdEvents(qTask_t *Task){
+    if(Task->FdEvents & qFD_READABLE){
+        Task->FdEvents &= (uint8_t)~qFD_READABLE; /*the event gets consumed by this dispatch*/
+        return byFdReadable;
+    }
+    if(Task->FdEvents & qFD_WRITABLE){
+        Task->FdEvents &= (uint8_t)~qFD_WRITABLE;
+        return byFdWritable;
+    }
+    return qTriggerNULL;
 }
 /*============================================================================*/
-/*void qSchedule(void)
-    
-Executes the task-scheduler scheme. It must be called once after the task
-pool has been defined.
-
-  Note : qScheduleRun keeps the application in an endless loop
+/*void qSchedulerWakeup(void)
+
+Wakes-up the scheduler if it's blocked waiting for the file descriptors 
+readiness, so it can re-evaluate the tasks. qTaskSendEvent, qTaskQueueEvent, 
+the messages and the ring-buffer pushes already call it, use it after changing
+any other condition from another thread (e.g. qSchedulerRelease).
+This API is thread-safe and async-signal-safe. 
+(Linux only)
 */
-void qSchedulerRun(void){
-    qTask_t *Task = NULL; /*this pointer will hold the current node from the chain and/or the top enqueue node if available*/
-    qSchedulerStartPoint{
-        #ifdef Q_AUTO_CHAINREARRANGE
-        if(!QUARKTS.Flag.Init) QUARKTS.Head = _qScheduler_RearrangeChain(QUARKTS.Head); /*if initial scheduling conditions changed, sort the chain by priority (init flag internally set)*/
+void qSchedulerWakeup(void){
+    uint64_t One = 1u;
+    if(QUARKTS.FdWakeup < 0) return; /*no file descriptors linked, the scheduler never blocks*/
+    _qAtomic_Fence(); /*the new work is visible before checking the scheduler state (see _qScheduler_FdWait)*/
+    if(QUARKTS.FdSleeping){
+        if(write(QUARKTS.FdWakeup, &One, sizeof(One)) < 0) return; /*the counter is already signaled*/
+    }
+}
+/*============================================================================*/
+static int _qScheduler_FdWaitTimeout(void){ /*get the time (in ms) until the next time-event of the chain, or -1 to wait forever*/
+    qTask_t *Task;
+    qClock_t elapsed, remaining, min = 0ul;
+    qTime_t ms;
+    qBool_t timed = qFalse;
+    #ifdef Q_PRIORITY_QUEUE
+    if(QUARKTS.QueueIndex >= 0) return 0;
+    #endif
+    #ifdef Q_IDLE_WORK
+    if(NULL != QUARKTS.IdleWorkHead) return 0; /*the deferred work must keep running*/
+    #endif
+    #ifdef Q_DEFERRED_CALLS
+    if(NULL != QUARKTS.DeferredCalls && _qAtomic_Load(&QUARKTS.DeferredCalls[QUARKTS.DeferredDequeue & QUARKTS.DeferredMask].Sequence) == QUARKTS.DeferredDequeue + 1u) return 0; /*a call is already pending*/
+    #endif
+    for(Task = QUARKTS.Head; Task; Task = Task->Next){
+        if(Task->Flag[_qIndex_AsyncRun] || Task->FdEvents) return 0;
+        #ifdef Q_TASK_GROUPS
+        if(Task->Flag[_qIndex_GroupPending]) return 0; /*the fork of a task group is waiting*/
         #endif
-        #ifdef Q_PRIORITY_QUEUE
-        if((Task = _qScheduler_PriorityQueueGet())) Task->State = _qScheduler_Dispatch(Task, byQueueExtraction);  /*Available queueded task will be dispatched in every scheduling cycle : the queue has the higher precedence*/    
+        #ifdef Q_RINGBUFFERS
+        if(qTriggerNULL != _qCheckRBufferEvents(Task)) return 0; /*the linked ring buffer has an event (e.g. data pushed by another thread)*/
         #endif
-        if(_qScheduler_ReadyTasksAvailable()){  /*Check if all the tasks from the chain fulfill the conditions to get the qReady state, if at least one gained it,  enter here*/
-            while((Task = _qScheduler_GetNodeFromChain())) /*Get node by node from the chain until no more available*/
-                Task->State = (qTaskState_t) ((qReady == Task->State) ? _qScheduler_Dispatch(Task, Task->Trigger) : qWaiting);  /*Dispatch the qReady tasks, otherwise put it in qWaiting State*/
+        if(_qCRPark_Active == Task->CRPark.State){
+            elapsed = _qSysTick_Epochs_ - Task->CRPark.ClockStart;
+            remaining = (elapsed >= Task->CRPark.Interval)? 0ul : Task->CRPark.Interval - elapsed;
         }
-        else if(NULL==Task && QUARKTS.IDLECallback) _qScheduler_Dispatch(NULL, byNoReadyTasks); /*no tasks are available for execution, run the idle task*/
-    }qSchedulerEndPoint; /*scheduling end-point (also check for scheduling-release request)*/
+        else if(Task->Flag[_qIndex_Enabled] && _qTaskHasPendingIterations(Task)){
+            elapsed = _qSysTick_Epochs_ - Task->ClockStart;
+            remaining = (elapsed >= Task->Interval)? 0ul : Task->Interval - elapsed;
+        }
+        else continue;
+        if(!timed || remaining < min) min = remaining;
+        timed = qTrue;
+    }
+    if(NULL != QUARKTS.IDLECallback && (!timed || min > 1ul)){ /*the idle task should be launched at least once per tick*/
+        min = 1ul;
+        timed = qTrue;
+    }
+    if(!timed){
+        if(QUARKTS.FdWakeup >= 0) return -1; /*the events from other threads will wake-up the scheduler*/
+        min = 1ul; /*nothing can wake-up the scheduler, poll once per tick*/
+    }
+    ms = qClock2Time(min)*1000.0f;
+    return (ms < (qTime_t)_qFD_WAIT_MAX_MS)? (int)ms + 1 : _qFD_WAIT_MAX_MS; /*round-up to the next millisecond, the far deadlines are split in several waits (the conversion must stay in the range of int)*/
 }
 /*============================================================================*/
-static qTask_t* _qScheduler_GetNodeFromChain(void){ 
-    static qTask_t *ChainIterator = __qChainInitializer; /*used to keep on track the current chain position*/
-    qTask_t *Node;  /*used the hold the node*/
-    if(__qChainInitializer == ChainIterator) ChainIterator = QUARKTS.Head; /*First call, start from the head*/
-    Node = ChainIterator; /*obtain the current node from the chain*/
-    ChainIterator = (ChainIterator)? ChainIterator->Next : QUARKTS.Head; /*Tail reached, reset the iterator to the head*/
+static void _qScheduler_FdWait(const qBool_t Block){
+    struct epoll_event ev[Q_FD_EVENTS_BATCH];
+    int i, n, Timeout = 0;
+    uint64_t Count;
+    qTask_t *Task;
+    if(QUARKTS.FdPoller < 0) return; /*no file descriptors linked*/
+    if(Block){
+        QUARKTS.FdSleeping = qTrue;
+        _qAtomic_Fence(); /*either the producers see the sleeping state or the timeout computation sees their work (see qSchedulerWakeup)*/
+        Timeout = _qScheduler_FdWaitTimeout();
+    }
+    n = epoll_wait(QUARKTS.FdPoller, ev, Q_FD_EVENTS_BATCH, Timeout);
+    QUARKTS.FdSleeping = qFalse;
+    for(i = 0; i < n; i++){
+        Task = (qTask_t*)ev[i].data.ptr;
+        if(NULL == Task){ /*a wake-up request, just clear it*/
+            if(read(QUARKTS.FdWakeup, &Count, sizeof(Count)) < 0) Count = 0u; /*already cleared*/
+            continue;
+        }
+        if(ev[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) Task->FdEvents |= qFD_READABLE; /*hang-up and errors are reported as readable, so the task can catch them when reading*/
+        if(ev[i].events & EPOLLOUT) Task->FdEvents |= qFD_WRITABLE;
+    }
+}
+#endif
+#ifdef Q_TASK_GROUPS
+/*============================================================================*/
+/*qBool_t qTaskGroupInit(qTaskGroup_t *Group, qTask_t **Members, void **Results, uint8_t NumberOfMembers, qTask_t *JoinTask)
+
+Initializes a task group (fork-join). When the group is started, all the members
+get an asynchronous event. The scheduler keeps track of the members completion 
+and when the last member returns, the join task is launched with an 
+asynchronous event having a pointer to the group in the <EventData> field, so
+the collected results can be read from the <Results> field of the group.
+
+Parameters:
+
+    - Group : A pointer to the task group object.
+    - Members : An array of pointers to the member tasks. The tasks must be 
+                previously added to the scheduling scheme and a task can only 
+                be member of one group (a task can't be moved from a busy 
+                group).
+    - Results : An array of <NumberOfMembers> pointers where the results of 
+                every member will be collected (see qTaskGroupSetResult). 
+                Pass NULL if results are not needed.
+    - NumberOfMembers : Number of elements of the <Members> array.
+    - JoinTask : A pointer to the task that will be launched when all the
+                 members complete.
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse (i.e. a member belongs to
+    a busy group);
+*/
+qBool_t qTaskGroupInit(qTaskGroup_t *Group, qTask_t **Members, void **Results, uint8_t NumberOfMembers, qTask_t *JoinTask){
+    uint8_t i;
+    if(NULL==Group || NULL==Members || NULL==JoinTask || 0u==NumberOfMembers) return qFalse;
+    for(i=0;i<NumberOfMembers;i++){
+        if(NULL==Members[i]) return qFalse;
+        if(NULL!=Members[i]->Group && Members[i]->Group->Pending > 0u) return qFalse; /*its current group still waits for it*/
+    }
+    Group->Members = Members;
+    Group->Results = Results;
+    Group->JoinTask = JoinTask;
+    Group->EventData = NULL;
+    Group->NumberOfMembers = NumberOfMembers;
+    Group->Pending = 0u;
+    for(i=0;i<NumberOfMembers;i++){
+        Members[i]->Group = Group;
+        Members[i]->GroupIndex = i;
+        Members[i]->Flag[_qIndex_GroupPending] = qFalse;
+    }
+    return qTrue;
+}
+/*============================================================================*/
+/*qBool_t qTaskGroupStart(qTaskGroup_t *Group, void *eventdata)
+
+Starts the task group (fork). Every member gets an asynchronous event with the 
+specified user-data. A member completes when its callback returns from the 
+dispatch triggered by this asynchronous event. The fork event is kept apart 
+from the events sent with qTaskSendEvent, so they don't replace it and they 
+don't count as the member completion. A member removed from the scheduling 
+scheme completes with a NULL result and leaves the group.
+
+Parameters:
+
+    - Group : A pointer to the task group object.
+    - eventdata : Specific event user-data for all the members.
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse (i.e. the previous fork
+    has not been joined yet, or a member left the group).
+*/
+qBool_t qTaskGroupStart(qTaskGroup_t *Group, void *eventdata){
+    uint8_t i;
+    if(NULL==Group) return qFalse;
+    if(Group->Pending > 0u) return qFalse; /*the previous fork is still running*/
+    for(i=0;i<Group->NumberOfMembers;i++){
+        if(Group != Group->Members[i]->Group) return qFalse; /*the member was removed or moved to another group*/
+    }
+    Group->EventData = eventdata;
+    Group->Pending = Group->NumberOfMembers;
+    for(i=0;i<Group->NumberOfMembers;i++){
+        if(NULL != Group->Results) Group->Results[i] = NULL;
+        Group->Members[i]->Flag[_qIndex_GroupPending] = qTrue; /*the fork is dispatched as an async event*/
+    }
+    _qScheduler_Notify();
+    return qTrue;
+}
+/*============================================================================*/
+/*qBool_t qTaskGroupSetResult(void *Result)
+
+Set the result of the current running task for its task group. This API should
+be called from the callback of a group member before it returns.
+
+Parameters:
+
+    - Result : The member result. It will be available in the <Results> array 
+               of the group at the member index.
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse (i.e. the running task 
+    is not a pending member of a group).
+*/
+qBool_t qTaskGroupSetResult(void *Result){
+    qTask_t *Task = QUARKTS.CurrentRunningTask;
+    if(NULL==Task) return qFalse;
+    if(NULL==Task->Group || !Task->Flag[_qIndex_GroupPending]) return qFalse;
+    if(NULL==Task->Group->Results) return qFalse;
+    Task->Group->Results[Task->GroupIndex] = Result;
+    return qTrue;
+}
+/*============================================================================*/
+/*qBool_t qTaskGroupIsBusy(const qTaskGroup_t *Group)
+
+Check if the task group has been started and not all of its members have 
+completed yet.
+
+Parameters:
+
+    - Group : A pointer to the task group object.
+
+Return value:
+
+    Returns qTrue if there are pending members, otherwise returns qFalse.
+*/
+qBool_t qTaskGroupIsBusy(const qTaskGroup_t *Group){
+    if(NULL==Group) return qFalse;
+    return (qBool_t)(Group->Pending > 0u);
+}
+/*============================================================================*/
+static void _qTaskGroup_MemberCompleted(qTask_t *Task){
+    qTaskGroup_t *Group = Task->Group;
+    Task->Flag[_qIndex_GroupPending] = qFalse;
+    if(Group->Pending > 0u){
+        if(0u == --Group->Pending) qTaskSendEvent(Group->JoinTask, (void*)Group); /*the last member returned, launch the join task*/
+    }
+}
+#endif
+#if !defined(_qAtomic_LockFree)
+/*============================================================================*/
+static qBool_t _qAtomic_CASFallback(volatile uint32_t *Ptr, uint32_t *Expected, const uint32_t Desired){
+    qBool_t RetValue;
+    qEnterCritical();
+    if((RetValue = (qBool_t)(*Ptr == *Expected))) *Ptr = Desired;
+    else *Expected = *Ptr;
+    qExitCritical();
+    return RetValue;
+}
+#endif
+#ifdef Q_DEFERRED_CALLS
+/*============================================================================*/
+void _qInitDeferredCalls(qDeferredCall_t *Area, const uint32_t Size){
+    uint32_t i, n = 1u;
+    if(NULL==Area || 0u==Size) return;
+    while((n << 1) <= Size && (n << 1) != 0u) n <<= 1; /*the largest power of two that fits*/
+    for(i=0u;i<n;i++) Area[i].Sequence = i; /*every record is free for the producer at the position <i>*/
+    QUARKTS.DeferredEnqueue = QUARKTS.DeferredDequeue = 0u;
+    QUARKTS.DeferredMask = n - 1u;
+    QUARKTS.DeferredCalls = Area;
+}
+/*============================================================================*/
+/*qBool_t qDeferredCall(qDeferredFcn_t Fcn, void *Arg)
+
+Queues a call to be executed by the scheduler in the task context. The 
+pending calls are executed at the beginning of every scheduling cycle, before
+any queued event or ready task (the deferred calls have the highest precedence).
+This API is lock-free and can be called from any ISR or thread (see 
+qSchedulerSetupDeferredCalls). On targets without a native compare-and-swap 
+(e.g. AVR or ARMv6-M), the queue positions are claimed inside a critical 
+section instead (see qSchedulerSetInterruptsED). If the scheduler is blocked waiting for the file
+descriptors, it gets woken-up (see qSchedulerWakeup).
+
+Parameters:
+
+    - Fcn : The function to call: void DeferredFcn(void *Arg)
+    - Arg : The argument passed to the function.
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse (the queue is full).
+*/
+qBool_t qDeferredCall(qDeferredFcn_t Fcn, void *Arg){
+    qDeferredCall_t *Call;
+    uint32_t Pos, Seq;
+    int32_t diff;
+    if(NULL==Fcn || NULL==QUARKTS.DeferredCalls) return qFalse;
+    Pos = _qAtomic_Load(&QUARKTS.DeferredEnqueue);
+    for(;;){ /*claim a record*/
+        Call = &QUARKTS.DeferredCalls[Pos & QUARKTS.DeferredMask];
+        Seq = _qAtomic_Load(&Call->Sequence);
+        diff = (int32_t)(Seq - Pos);
+        if(0 == diff){ /*the record is free, try to take this position*/
+            if(_qAtomic_CAS(&QUARKTS.DeferredEnqueue, &Pos, Pos + 1u)) break;
+        }
+        else if(diff < 0) return qFalse; /*the record still holds a pending call : the queue is full*/
+        else Pos = _qAtomic_Load(&QUARKTS.DeferredEnqueue); /*another producer took this position*/
+    }
+    Call->Fcn = Fcn;
+    Call->Arg = Arg;
+    _qAtomic_Store(&Call->Sequence, Pos + 1u); /*publish the record to the consumer*/
+    _qScheduler_Notify(); /*the scheduler could be blocked waiting for the file descriptors*/
+    return qTrue;
+}
+/*============================================================================*/
+static void _qScheduler_DeferredCallsRun(void){ /*run the pending deferred calls (only the ones available at the beginning, so a call can defer another one)*/
+    qDeferredCall_t *Call;
+    qDeferredFcn_t Fcn;
+    void *Arg;
+    uint32_t Pos, n = 0u;
+    if(NULL == QUARKTS.DeferredCalls) return;
+    Pos = QUARKTS.DeferredDequeue;
+    while(n++ <= QUARKTS.DeferredMask){
+        Call = &QUARKTS.DeferredCalls[Pos & QUARKTS.DeferredMask];
+        if(_qAtomic_Load(&Call->Sequence) != Pos + 1u) break; /*no more published calls*/
+        Fcn = Call->Fcn;
+        Arg = Call->Arg;
+        _qAtomic_Store(&Call->Sequence, Pos + QUARKTS.DeferredMask + 1u); /*release the record for the next lap*/
+        QUARKTS.DeferredDequeue = ++Pos;
+        Fcn(Arg);
+        #ifdef Q_FD_EVENTS
+        QUARKTS.FdBlock = qFalse;
+        #endif
+    }
+    #ifdef Q_SCHEDULER_STATS
+    if(n > 1u) _qScheduler_StatsAccount(qTrue); /*the time spent on the deferred calls is busy time*/
+    #endif
+}
+#endif
+#ifdef Q_IDLE_WORK
+/*============================================================================*/
+/*qBool_t qIdleWorkSubmit(qIdleWork_t *Work, qIdleWorkFcn_t Fcn, void *Data, qTime_t Slice)
+
+Submits a work item to the idle-time deferred work queue. Pending work items 
+are executed in FIFO order (one time slice per scheduling cycle) only when 
+there is no ready task. While work is pending, the work items take the place 
+of the idle task.
+The work function receives a pointer to the work item and must return as soon 
+as qIdleWorkSliceExpired(Work) is qTrue. Returning qTrue means the work is done 
+and the item leaves the queue. Returning qFalse means the work is not finished, 
+so the item is placed at the end of the queue to be resumed later.
+An item can be submitted again from its own work function after being 
+cancelled, in that case it will be placed at the end of the queue once the 
+work function returns, regardless of its return value.
+
+Parameters:
+
+    - Work : A pointer to the work item object.
+    - Fcn : The work function: qBool_t WorkFcn(qIdleWork_t *Work)
+    - Data : The work arguments, available in the <Data> field of the item.
+    - Slice : The time slice in seconds (floating-point format). A ready task 
+              will not be delayed longer than this value.
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse (the item is already 
+    pending).
+*/
+qBool_t qIdleWorkSubmit(qIdleWork_t *Work, qIdleWorkFcn_t Fcn, void *Data, const qTime_t Slice){
+    if(NULL==Work || NULL==Fcn) return qFalse;
+    if(Work->Pending) return qFalse;
+    Work->Fcn = Fcn;
+    Work->Data = Data;
+    Work->Slice = qTime2Clock(Slice);
+    qEnterCritical();
+    if(QUARKTS.IdleWorkRunning == Work){ /*the item is running, it gets queued when its work function returns*/
+        QUARKTS.IdleWorkResubmit = qTrue;
+    }
+    else{
+        Work->Next = NULL;
+        if(NULL == QUARKTS.IdleWorkTail) QUARKTS.IdleWorkHead = Work;
+        else QUARKTS.IdleWorkTail->Next = Work;
+        QUARKTS.IdleWorkTail = Work;
+    }
+    Work->Pending = qTrue;
+    qExitCritical();
+    return qTrue;
+}
+/*============================================================================*/
+/*qBool_t qIdleWorkCancel(qIdleWork_t *Work)
+
+Removes a pending work item from the idle-time deferred work queue. If the 
+item is running, it will not be resumed after its work function returns.
+
+Parameters:
+
+    - Work : A pointer to the work item object.
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse (the item was not pending).
+*/
+qBool_t qIdleWorkCancel(qIdleWork_t *Work){
+    qIdleWork_t *w, *prev = NULL;
+    qBool_t RetValue = qFalse;
+    if(NULL==Work) return qFalse;
+    qEnterCritical();
+    for(w = QUARKTS.IdleWorkHead; w; prev = w, w = w->Next){
+        if(w == Work){
+            if(NULL == prev) QUARKTS.IdleWorkHead = w->Next;
+            else prev->Next = w->Next;
+            if(QUARKTS.IdleWorkTail == w) QUARKTS.IdleWorkTail = prev;
+            w->Next = NULL;
+            w->Pending = qFalse;
+            RetValue = qTrue;
+            break;
+        }
+    }
+    if(QUARKTS.IdleWorkRunning == Work){ /*the item is out of the queue while running, it will not be resumed*/
+        RetValue = (qBool_t)Work->Pending;
+        Work->Pending = qFalse;
+        QUARKTS.IdleWorkResubmit = qFalse;
+    }
+    qExitCritical();
+    return RetValue;
+}
+/*============================================================================*/
+/*qBool_t qIdleWorkIsPending(const qIdleWork_t *Work)
+
+Check if the work item is in the idle-time deferred work queue.
+
+Parameters:
+
+    - Work : A pointer to the work item object.
+
+Return value:
+
+    Returns qTrue if the work item is pending, otherwise returns qFalse.
+*/
+qBool_t qIdleWorkIsPending(const qIdleWork_t *Work){
+    if(NULL==Work) return qFalse;
+    return (qBool_t)Work->Pending;
+}
+/*============================================================================*/
+/*qBool_t qIdleWorkSliceExpired(const qIdleWork_t *Work)
+
+Check if the time slice of the work item expired. The work function must 
+poll this API and return as soon as it gets qTrue.
+
+Parameters:
+
+    - Work : A pointer to the work item object.
+
+Return value:
+
+    Returns qTrue if the time slice expired, otherwise returns qFalse.
+*/
+qBool_t qIdleWorkSliceExpired(const qIdleWork_t *Work){
+    if(NULL==Work) return qTrue;
+    return (qBool_t)((_qSysTick_Epochs_ - Work->SliceStart) >= Work->Slice);
+}
+/*============================================================================*/
+static void _qScheduler_IdleWorkRun(void){ /*run one time slice of the work item at the front of the deferred work queue*/
+    qIdleWork_t *Work;
+    qBool_t Done;
+    qEnterCritical();
+    Work = QUARKTS.IdleWorkHead; /*take the item out of the queue while it runs, so the work function can submit or cancel items*/
+    if(NULL != Work){
+        QUARKTS.IdleWorkHead = Work->Next;
+        if(NULL == QUARKTS.IdleWorkHead) QUARKTS.IdleWorkTail = NULL;
+        Work->Next = NULL;
+        QUARKTS.IdleWorkRunning = Work;
+        QUARKTS.IdleWorkResubmit = qFalse;
+    }
+    qExitCritical();
+    if(NULL == Work) return;
+    Work->SliceStart = _qSysTick_Epochs_;
+    Done = Work->Fcn(Work);
+    qEnterCritical();
+    if(Work->Pending && (!Done || QUARKTS.IdleWorkResubmit)){ /*not finished yet or submitted again, resume it later (unless it was cancelled while running)*/
+        if(NULL == QUARKTS.IdleWorkTail) QUARKTS.IdleWorkHead = Work;
+        else QUARKTS.IdleWorkTail->Next = Work;
+        QUARKTS.IdleWorkTail = Work;
+    }
+    else{
+        Work->Pending = qFalse;
+    }
+    QUARKTS.IdleWorkRunning = NULL;
+    QUARKTS.IdleWorkResubmit = qFalse;
+    qExitCritical();
+}
+#endif
+/*============================================================================*/
+static void _qTriggerReleaseSchedEvent(void){
+    QUARKTS.Flag.Init = qFalse;
+    QUARKTS.Flag.ReleaseSched = qFalse;   
+    QUARKTS.EventInfo.FirstCall = (qBool_t)(!QUARKTS.Flag.FCallReleased);    
+    QUARKTS.EventInfo.Trigger = bySchedulingRelease;
+    QUARKTS.EventInfo.TaskData = NULL;
+    if(QUARKTS.ReleaseSchedCallback!=NULL) QUARKTS.ReleaseSchedCallback((qEvent_t)&QUARKTS.EventInfo);
+    QUARKTS.Flag.FCallIdle = qTrue;      
+}
+/*============================================================================*/
+/*
+void qSchedulerSysTick(void)
+
+Feed the scheduler system tick. This call is mandatory and must be called once
+inside the dedicated timer interrupt service routine (ISR). 
+*/    
+void qSchedulerSysTick(void){_qSysTick_Epochs_++;}
+/*============================================================================*/
+qClock_t qSchedulerGetTick(void){
+	return _qSysTick_Epochs_;
+}
+/*============================================================================*/
+/*void qSchedule(void)
+    
+Executes the task-scheduler scheme. It must be called once after the task
+pool has been defined.
+
+  Note : qScheduleRun keeps the application in an endless loop
+*/
+void qSchedulerRun(void){
+    qTask_t *Task = NULL; /*this pointer will hold the current node from the chain and/or the top enqueue node if available*/
+    #ifdef Q_SCHEDULER_STATS
+    uint16_t nReady; /*number of ready tasks dispatched in the current cycle*/
+    #endif
+    qSchedulerStartPoint{
+        #ifdef Q_AUTO_CHAINREARRANGE
+        if(!QUARKTS.Flag.Init) QUARKTS.Head = _qScheduler_RearrangeChain(QUARKTS.Head); /*if initial scheduling conditions changed, sort the chain by priority (init flag internally set)*/
+        #endif
+        #ifdef Q_FD_EVENTS
+        _qScheduler_FdWait(QUARKTS.FdBlock); /*retrieve the file descriptors readiness, blocking only if the previous cycle had nothing to do*/
+        #ifdef Q_SCHEDULER_STATS
+        if(QUARKTS.FdBlock) _qScheduler_StatsAccount(qFalse); /*the time blocked waiting for the file descriptors is idle time*/
+        #endif
+        QUARKTS.FdBlock = qTrue;
+        #endif
+        #ifdef Q_SCHEDULER_STATS
+        QUARKTS.Stats.Cycles++;
+        nReady = 0u;
+        #endif
+        #ifdef Q_DEFERRED_CALLS
+        _qScheduler_DeferredCallsRun(); /*the calls deferred from the ISRs have the highest precedence*/
+        #endif
+        #ifdef Q_PRIORITY_QUEUE
+        if((Task = _qScheduler_PriorityQueueGet())){
+            #ifdef Q_SCHEDULER_STATS
+            QUARKTS.Stats.QueueExtractions++;
+            #endif
+            Task->State = _qScheduler_Dispatch(Task, byQueueExtraction);  /*Available queueded task will be dispatched in every scheduling cycle : the queue has the higher precedence*/    
+        }
+        #endif
+        if(_qScheduler_ReadyTasksAvailable()){  /*Check if all the tasks from the chain fulfill the conditions to get the qReady state, if at least one gained it,  enter here*/
+            #ifdef Q_FD_EVENTS
+            QUARKTS.FdBlock = qFalse;
+            #endif
+            while((Task = _qScheduler_GetNodeFromChain())){ /*Get node by node from the chain until no more available*/
+                #ifdef Q_SCHEDULER_STATS
+                if(qReady == Task->State) nReady++;
+                #endif
+                Task->State = (qTaskState_t) ((qReady == Task->State) ? _qScheduler_Dispatch(Task, Task->Trigger) : qWaiting);  /*Dispatch the qReady tasks, otherwise put it in qWaiting State*/
+            }
+        }
+        #ifdef Q_IDLE_WORK
+        else if(NULL==Task && NULL!=QUARKTS.IdleWorkHead) _qScheduler_IdleWorkRun(); /*no tasks are available for execution, run a slice of the deferred work*/
+        #endif
+        else if(NULL==Task && QUARKTS.IDLECallback){
+            #ifdef Q_SCHEDULER_STATS
+            QUARKTS.Stats.IdleDispatches++;
+            #endif
+            _qScheduler_Dispatch(NULL, byNoReadyTasks); /*no tasks are available for execution, run the idle task*/
+        }
+        #ifdef Q_SCHEDULER_STATS
+        QUARKTS.Stats.ReadyTasks += nReady;
+        if(nReady > QUARKTS.Stats.MaxReadyTasks) QUARKTS.Stats.MaxReadyTasks = nReady;
+        _qScheduler_StatsAccount((qBool_t)(nReady > 0u || NULL != Task)); /*the cycle is busy if at least one task was dispatched*/
+        #endif
+    }qSchedulerEndPoint; /*scheduling end-point (also check for scheduling-release request)*/
+}
+/*============================================================================*/
+static qTask_t* _qScheduler_GetNodeFromChain(void){ 
+    qTask_t *Node;  /*used the hold the node*/
+    if(__qChainInitializer == QUARKTS.ChainIterator) QUARKTS.ChainIterator = QUARKTS.Head; /*First call, start from the head*/
+    Node = QUARKTS.ChainIterator; /*obtain the current node from the chain*/
+    QUARKTS.ChainIterator = (QUARKTS.ChainIterator)? QUARKTS.ChainIterator->Next : QUARKTS.Head; /*Tail reached, reset the iterator to the head*/
     return Node; /*return the task node at current chain position*/
 }
 /*============================================================================*/
 static qTaskState_t _qScheduler_Dispatch(qTask_t *Task, const qTrigger_t Event){
+    #ifdef Q_MESSAGES
+    void *PendingMsg = NULL; /*the message reference owned by this dispatch*/
+    #endif
+    #ifdef Q_RINGBUFFERS
+    qRBuffer_t *PoppedRBuffer = NULL; /*the ring buffer whose front element is handed to this dispatch*/
+    qRBIndex_t PoppedIndex = 0u;
+    #endif
+    #ifdef Q_TASK_GROUPS
+    qBool_t GroupFork = qFalse; /*this dispatch delivers the fork of the task group*/
+    #endif
     switch(Event){ /*take the necessary actions before dispatching, depending on the event that triggered the task*/
         case byTimeElapsed:
+            if(_qCRPark_Active == Task->CRPark.State) break; /*wake-up from a coroutine parking, the iteration counter is not affected*/
             /*handle the iteration value and the FirstIteration flag*/
             Task->Iterations = (QUARKTS.EventInfo.FirstIteration = (qBool_t)((Task->Iterations!=qPeriodic) && (Task->Iterations<0)))? -Task->Iterations : Task->Iterations;
             if(Task->Iterations!= qPeriodic) Task->Iterations--; /*Decrease the iteration value*/
             if((QUARKTS.EventInfo.LastIteration = (qBool_t)(Task->Iterations == 0))) Task->Flag[_qIndex_Enabled] = qFalse; /*When the iteration value is reached, the task will be disabled*/            
             break;
         case byAsyncEvent:
+            #ifdef Q_TASK_GROUPS
+            if(Task->Flag[_qIndex_GroupPending]){ /*any other async event stays pending for the next dispatch*/
+                QUARKTS.EventInfo.EventData = Task->Group->EventData;
+                GroupFork = qTrue;
+                break;
+            }
+            #endif
+            #ifdef Q_MESSAGES
+            qEnterCritical(); /*the data and the message flag must be taken together*/
+            if(Task->Flag[_qIndex_AsyncMsg]) PendingMsg = Task->AsyncData;
+            Task->Flag[_qIndex_AsyncMsg] = qFalse;
+            #endif
             QUARKTS.EventInfo.EventData = Task->AsyncData; /*Transfer async-data to the eventinfo structure*/
             Task->Flag[_qIndex_AsyncRun] = qFalse; /*Clear the async flag*/            
+            #ifdef Q_MESSAGES
+            qExitCritical();
+            #endif
             break;
         #ifdef Q_RINGBUFFERS    
         case byRBufferPop:
-            QUARKTS.EventInfo.EventData = qRBufferGetFront(Task->RingBuff); /*the EventData will point to the RBuffer front-data*/
+            #ifdef Q_RBUFFER_MPMC
+            if(_qRBufferIsMPMC(Task->RingBuff)){ /*claim the front slot, it is given back to the producers after the dispatch*/
+                if(NULL == (QUARKTS.EventInfo.EventData = _qRBufferClaimFront(Task->RingBuff, &PoppedIndex))) return qSuspended; /*another consumer took the element*/
+                PoppedRBuffer = Task->RingBuff;
+                break;
+            }
+            #endif
+            if(NULL != (QUARKTS.EventInfo.EventData = _qRBufferFront(Task->RingBuff, &PoppedIndex))) PoppedRBuffer = Task->RingBuff; /*the EventData will point to the RBuffer front-data*/
             break;
         case byRBufferFull: case byRBufferCount: case byRBufferEmpty: 
             QUARKTS.EventInfo.EventData = (void*)Task->RingBuff;  /*the EventData will point to the the linked RingBuffer*/
             break;
         #endif
+        #ifdef Q_FD_EVENTS
+        case byFdReadable: case byFdWritable:
+            QUARKTS.EventInfo.EventData = (void*)&Task->Fd; /*the EventData will point to the linked file descriptor*/
+            break;
+        #endif
         #ifdef Q_PRIORITY_QUEUE
         case byQueueExtraction:
             QUARKTS.EventInfo.EventData = QUARKTS.QueueData; /*get the extracted data from queue*/
+            #ifdef Q_MESSAGES
+            if(QUARKTS.QueueMessage) PendingMsg = QUARKTS.QueueData;
+            QUARKTS.QueueMessage = qFalse;
+            #endif
             QUARKTS.QueueData = NULL;
             break;
         #endif
@@ -786,6 +1982,7 @@ static qTaskState_t _qScheduler_Dispatch(qTask_t *Task, const qTrigger_t Event){
             QUARKTS.EventInfo.Trigger = Event;
             QUARKTS.EventInfo.TaskData = NULL;
             QUARKTS.IDLECallback((qEvent_t)&QUARKTS.EventInfo); /*run the idle callback*/
+            _qScheduler_ScratchReset(); /*the scratch memory only lives during the dispatch*/
             QUARKTS.Flag.FCallIdle = qTrue;      
             return qSuspended; /*No more things to do*/
         default: break;
@@ -797,25 +1994,47 @@ static qTaskState_t _qScheduler_Dispatch(qTask_t *Task, const qTrigger_t Event){
     if (Task->StateMachine != NULL && __qFSMCallbackMode==Task->Callback) qStateMachine_Run(Task->StateMachine, (void*)&QUARKTS.EventInfo);  /*If the task has a FSM attached, just run it*/  
     else if (Task->Callback != NULL) Task->Callback((qEvent_t)&QUARKTS.EventInfo); /*else, just launch the callback function*/        
     QUARKTS.CurrentRunningTask = NULL;
+    _qScheduler_ScratchReset(); /*the scratch memory only lives during the dispatch*/
+    #ifdef Q_MESSAGES
+    qMessageRelease(PendingMsg); /*the consumer is done with the message, drop its reference*/
+    #endif
     #ifdef Q_RINGBUFFERS 
-    if(Event==byRBufferPop) Task->RingBuff->tail++;  /*remove the data from the RBuffer, if the event was byRBufferPop*/
+    if(NULL != PoppedRBuffer) _qRBufferDropFront(PoppedRBuffer, PoppedIndex); /*remove the data from the RBuffer, if the event was byRBufferPop*/
+    #endif
+    #ifdef Q_TASK_GROUPS
+    if(GroupFork && Task->Flag[_qIndex_GroupPending]) _qTaskGroup_MemberCompleted(Task); /*track the completion of the group members (unless the member left the group during the dispatch)*/
     #endif
     Task->Flag[_qIndex_InitFlag] = qTrue; /*clear the init flag*/
     QUARKTS.EventInfo.FirstIteration = qFalse;
     QUARKTS.EventInfo.LastIteration =  qFalse; 
     QUARKTS.EventInfo.EventData = NULL; /*clear the eventdata*/
     Task->Cycles++; /*increase the task cycles value*/
+    #ifdef Q_MEMORY_MANAGER
+    if(QUARKTS.TaskToReclaim == Task){ /*the task destroyed itself*/
+        QUARKTS.TaskToReclaim = NULL;
+        _qTaskPool_Release(Task);
+    }
+    else if(byTimeElapsed == Event && 0 == Task->Iterations && _qCRPark_Active != Task->CRPark.State && _qTaskIsPooled(Task)) _qTaskPool_Release(Task); /*the pooled task performed all its iterations (and its coroutine is not parked), reclaim it*/
+    #endif
     return qSuspended;
 }
 /*============================================================================*/
 static qBool_t _qScheduler_ReadyTasksAvailable(void){ /*this method checks for tasks that fulfill the conditions to get the qReady state*/
     qTask_t *Task = NULL;
-    #ifdef Q_RINGBUFFERS 
+    #if defined(Q_RINGBUFFERS) || defined(Q_FD_EVENTS)
     qTrigger_t trg = qTriggerNULL;
     #endif
     qBool_t nTaskReady = qFalse; /*this flag will let me know if at least one task is in qReady state*/
     for(Task = QUARKTS.Head; Task; Task = Task->Next){ /*loop every task in the chain : only one event will be verified by node*/
-        if(Task->Flag[_qIndex_Enabled]){ /*nested check for timed task, check the first requirement(the task must be enabled)*/
+        if(_qCRPark_Active == Task->CRPark.State){ /*a parked coroutine only wakes-up when its parking time expires (even if the task is disabled)*/
+            if(_qCRParkExpired(&Task->CRPark)){
+                Task->State = qReady; /*Put the task in ready state*/
+                Task->Trigger = byTimeElapsed; /*Set the corresponding trigger*/
+                nTaskReady = qTrue; /*at least one task in the chain is ready to run*/
+                continue; /*check the next task*/  
+            }
+        }
+        else if(Task->Flag[_qIndex_Enabled]){ /*nested check for timed task, check the first requirement(the task must be enabled)*/
             if(_qTaskHasPendingIterations(Task)){ /*then task should be periodic or must have available iters*/
                 if(_qTaskDeadlineReached(Task)){ /*finally, check the time deadline*/
                     Task->ClockStart = _qSysTick_Epochs_; /*Restart the task time*/
@@ -834,6 +2053,22 @@ static qBool_t _qScheduler_ReadyTasksAvailable(void){ /*this method checks for t
             continue; /*check the next task*/
         }
         #endif
+        #ifdef Q_FD_EVENTS
+        if((trg=_qCheckFdEvents(Task)) != qTriggerNULL){ /*check if the linked file descriptor is ready*/
+            Task->State = qReady; /*Put the task in ready state*/
+            Task->Trigger = trg;
+            nTaskReady = qTrue;  /*at least one task in the chain is ready to run*/
+            continue; /*check the next task*/
+        }
+        #endif
+        #ifdef Q_TASK_GROUPS
+        if(Task->Flag[_qIndex_GroupPending]){ /*the fork event of the task group goes before any other async event*/
+            Task->State = qReady;
+            Task->Trigger = byAsyncEvent;
+            nTaskReady = qTrue;
+            continue;
+        }
+        #endif
         if( Task->Flag[_qIndex_AsyncRun]){   /*The last check will be if the task has an async event*/
             Task->State = qReady; /*Put the task in ready state*/
             Task->Trigger = byAsyncEvent; /*Set the corresponding trigger*/
@@ -1137,89 +2372,1263 @@ void qSTimerChangeTime(qSTimer_t *obj, const qTime_t Time){
     if(NULL==obj) return;
     qConstField_Set(qClock_t, obj->TV)/*obj->TV*/ = qTime2Clock(Time);
 }
-#ifdef Q_MEMORY_MANAGER
+#ifdef Q_TIMER_SERVICE
 /*============================================================================*/
-/*void* qMemoryAlloc(qMemoryPool_t *obj, uint16_t size)
- 
-Allocate the required memory from the specified memory heap. The allocation 
-is rounded to the memory block size.
- 
+/*qBool_t qCBTimerServiceStart(qTask_t *Task, qPriority_t Priority)
+
+Starts the callback timer service. The service adds a task to the scheduling 
+scheme, and all the timer callbacks are fired from this task. The armed 
+timers are kept in a hierarchical timing wheel, so starting, stopping and 
+expiring a timer is O(1) regardless of the number of armed timers.
+The service task is only enabled while there are armed timers.
+
 Parameters:
 
-    - obj : a pointer to the memory pool object
-    - size : amount of memory to allocate
- 
+    - Task : A pointer to the task node that will be used by the service.
+    - Priority : The service task priority.
+
 Return value:
 
-    A pointer to allocated memory or null if there is not available memory
- */
-void* qMemoryAlloc(qMemoryPool_t *obj, const qSize_t size){
-    uint8_t i, j, k, c;
-    uint16_t sum;		
-    uint8_t *offset = obj->Blocks;
-    if(NULL==obj) return NULL;			
-    j = 0;	
-    qEnterCritical();
-    while( j < obj->NumberofBlocks ) {	/*loop until we find a free memory block*/		
-        sum  = 0;
-        i = j;
-        while( i < obj->NumberofBlocks ) {		
-            if( *(obj->BlockDescriptors+i) ) {
-                offset += (*(obj->BlockDescriptors+i)) * (obj->BlockSize);
-                i += *(obj->BlockDescriptors+i);				 
-                continue;
-            }
-            break;				
-        }
-        
-        j = i;	/*<j> should be the index of the first free mem block and <offset> is the offset in the buffer*/
-        for(k = 1, i = j; i < obj->NumberofBlocks; k++, i++) {
-            if( *(obj->BlockDescriptors+i) ) {	 /*We haven't found the required amount of mem blocks. Continue with the next free memory block.*/		
-                j = (uint8_t)(i + *(obj->BlockDescriptors+i)); /*Increment j for the number of used memory blocks*/
-                offset = obj->Blocks;
-                offset += j * (obj->BlockSize);
-                break;
-            }
-            sum += obj->BlockSize;
-            if( sum >= size ) { /*memory area found*/
-                *(obj->BlockDescriptors+j) = k; /*leave the record*/
-                for(c=0;c<size;c++) offset[i] = 0x00u; /*zero-initialized memory block*/ 
-                qExitCritical();
-                return (void*)offset; /*return the pointer to the free memory block*/
-            }						
-        }
-        if( i == obj->NumberofBlocks ) break;
-    }
-    qExitCritical();
-    return NULL; /*memory not available*/
+    Returns qTrue on success, otherwise returns qFalse.
+*/
+qBool_t qCBTimerServiceStart(qTask_t *Task, qPriority_t Priority){
+    if(NULL==Task) return qFalse;
+    memset(&_qTimerWheel_, 0, sizeof(_qTimerWheel_t));
+    _qTimerWheel_.Now = _qSysTick_Epochs_;
+    _qTimerWheel_.Task = Task;
+    qSchedulerAddxTask(Task, _qCBTimer_ServiceTask, Priority, QUARKTS.Tick, qPeriodic, qDisabled, NULL); /*runs every tick while timers are armed*/
+    return qTrue;
 }
 /*============================================================================*/
-/*void* qMemoryFree(qMemoryPool_t *obj, void* pmem)
+/*qBool_t qCBTimerStart(qCBTimer_t *Timer, qCBTimerFcn_t Callback, void *Data, qTime_t Time, qBool_t AutoReload)
+
+Arms a callback timer. When the time expires, the callback is fired from the 
+timer service task. If the timer is already armed, it gets restarted.
+
+Parameters:
+
+    - Timer : A pointer to the timer object.
+    - Callback : The timer callback: void TimerCallback(qCBTimer_t *Timer)
+    - Data : The timer arguments, available in the <Data> field of the timer.
+    - Time : The expiration time(Must be specified in seconds).
+    - AutoReload : If qTrue, the timer is re-armed with the same <Time> after 
+                   every expiration. Otherwise, the timer fires only once.
+
+    > Note: The timers must be started or stopped from the task context.
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse.
+*/
+qBool_t qCBTimerStart(qCBTimer_t *Timer, qCBTimerFcn_t Callback, void *Data, const qTime_t Time, const qBool_t AutoReload){
+    qClock_t t;
+    if(NULL==Timer || NULL==Callback || NULL==_qTimerWheel_.Task) return qFalse;
+    qCBTimerStop(Timer);
+    t = qTime2Clock(Time);
+    if(0u == t) t = 1u; /*at least one tick*/
+    if(0u == _qTimerWheel_.Armed){ /*the wheel was stopped, sync it with the current time*/
+        _qTimerWheel_.Now = _qSysTick_Epochs_;
+        qTaskSetState(_qTimerWheel_.Task, qEnabled);
+    }
+    Timer->Callback = Callback;
+    Timer->Data = Data;
+    Timer->Period = (AutoReload)? t : 0u;
+    Timer->Expiry = _qSysTick_Epochs_ + t;
+    _qCBTimer_Insert(Timer);
+    Timer->Active = qTrue;
+    _qTimerWheel_.Armed++;
+    return qTrue;
+}
+/*============================================================================*/
+/*qBool_t qCBTimerStop(qCBTimer_t *Timer)
+
+Disarms a callback timer.
+
+Parameters:
+
+    - Timer : A pointer to the timer object.
+
+Return value:
+
+    Returns qTrue if the timer was armed, otherwise returns qFalse.
+*/
+qBool_t qCBTimerStop(qCBTimer_t *Timer){
+    if(NULL==Timer) return qFalse;
+    if(!Timer->Active) return qFalse;
+    _qCBTimer_Unlink(Timer);
+    Timer->Active = qFalse;
+    if(0u == --_qTimerWheel_.Armed) qTaskSetState(_qTimerWheel_.Task, qDisabled); /*nothing to do, stop the service task*/
+    return qTrue;
+}
+/*============================================================================*/
+/*qBool_t qCBTimerIsActive(const qCBTimer_t *Timer)
+
+Check if the callback timer is armed.
+
+Parameters:
+
+    - Timer : A pointer to the timer object.
+
+Return value:
+
+    Returns qTrue if the timer is armed, otherwise returns qFalse.
+*/
+qBool_t qCBTimerIsActive(const qCBTimer_t *Timer){
+    if(NULL==Timer) return qFalse;
+    return (qBool_t)Timer->Active;
+}
+/*============================================================================*/
+/*qClock_t qCBTimerRemaining(const qCBTimer_t *Timer)
+
+Get the remaining time(epochs) before the callback timer expires.
+
+Parameters:
+
+    - Timer : A pointer to the timer object.
+
+Return value:
+
+    The remaining time specified in epochs. Zero if the timer is not armed.
+*/
+qClock_t qCBTimerRemaining(const qCBTimer_t *Timer){
+    qClock_t r;
+    if(NULL==Timer) return 0u;
+    if(!Timer->Active) return 0u;
+    r = Timer->Expiry - _qSysTick_Epochs_;
+    return (r > _qTimerWheel_HalfRange)? 0u : r; /*zero if already due*/
+}
+/*============================================================================*/
+static void _qCBTimer_Insert(qCBTimer_t *Timer){ /*put the timer in the slot of the level that covers its remaining time*/
+    qClock_t delta = Timer->Expiry - _qTimerWheel_.Now, expiry = Timer->Expiry;
+    qCBTimer_t **slot;
+    uint8_t level;
+    if(0u == delta || delta > _qTimerWheel_HalfRange) expiry = _qTimerWheel_.Now; /*already due (only when cascading), it goes to the slot about to be processed*/
+    else if(delta >= _qTimerWheel_Span) expiry = _qTimerWheel_.Now + (_qTimerWheel_Span - 1u); /*beyond the wheel range, it will be re-inserted when cascaded*/
+    delta = expiry - _qTimerWheel_.Now;
+    for(level = 0u; level < (Q_TIMERWHEEL_LEVELS - 1u); level++){
+        if(delta < ((qClock_t)1u << (Q_TIMERWHEEL_BITS*(level + 1u)))) break;
+    }
+    slot = &_qTimerWheel_.Slots[level][(expiry >> (Q_TIMERWHEEL_BITS*level)) & _qTimerWheel_Mask];
+    Timer->Next = *slot; /*push at the front of the slot list*/
+    if(NULL != Timer->Next) Timer->Next->PrevNext = &Timer->Next;
+    Timer->PrevNext = slot;
+    *slot = Timer;
+}
+/*============================================================================*/
+static void _qCBTimer_Unlink(qCBTimer_t *Timer){
+    *Timer->PrevNext = Timer->Next;
+    if(NULL != Timer->Next) Timer->Next->PrevNext = Timer->PrevNext;
+    Timer->Next = NULL;
+    Timer->PrevNext = NULL;
+}
+/*============================================================================*/
+static void _qCBTimer_Cascade(const uint8_t Level){ /*move the timers of the current slot in <Level> to the lower levels*/
+    qCBTimer_t **slot = &_qTimerWheel_.Slots[Level][(_qTimerWheel_.Now >> (Q_TIMERWHEEL_BITS*Level)) & _qTimerWheel_Mask];
+    qCBTimer_t *Timer, *Next;
+    Timer = *slot;
+    *slot = NULL;
+    for(; Timer; Timer = Next){
+        Next = Timer->Next;
+        _qCBTimer_Insert(Timer);
+    }
+}
+/*============================================================================*/
+static void _qCBTimer_ServiceTask(qEvent_t e){
+    qCBTimer_t **slot, *Timer;
+    qClock_t remaining;
+    uint8_t level;
+    (void)e;
+    while(_qTimerWheel_.Now != _qSysTick_Epochs_ && _qTimerWheel_.Armed > 0u){ /*catch up with the current time, tick by tick*/
+        _qTimerWheel_.Now++;
+        for(level = 1u; level < Q_TIMERWHEEL_LEVELS; level++){ /*when a level wraps, cascade the current slot of the next level*/
+            if(0u != ((_qTimerWheel_.Now >> (Q_TIMERWHEEL_BITS*(level - 1u))) & _qTimerWheel_Mask)) break;
+            _qCBTimer_Cascade(level);
+        }
+        slot = &_qTimerWheel_.Slots[0][_qTimerWheel_.Now & _qTimerWheel_Mask];
+        while(NULL != (Timer = *slot)){ /*fire the expired timers one by one, the callbacks can start or stop any timer*/
+            _qCBTimer_Unlink(Timer);
+            remaining = Timer->Expiry - _qTimerWheel_.Now;
+            if(0u != remaining && remaining <= _qTimerWheel_HalfRange){ /*the timer was beyond the wheel range, it is not due yet*/
+                _qCBTimer_Insert(Timer);
+                continue;
+            }
+            if(Timer->Period > 0u){ /*re-arm before the callback, without drift*/
+                Timer->Expiry += Timer->Period;
+                _qCBTimer_Insert(Timer);
+            }
+            else{
+                Timer->Active = qFalse;
+                _qTimerWheel_.Armed--;
+            }
+            Timer->Callback(Timer);
+        }
+    }
+    if(0u == _qTimerWheel_.Armed) qTaskSetState(_qTimerWheel_.Task, qDisabled);
+}
+#endif
+#ifdef Q_MEMORY_MANAGER
+/*============================================================================*/
+void _qMemoryPoolInit(qMemoryPool_t *obj){ /*link all the blocks in the free-list*/
+    uint16_t i;
+    if(NULL==obj) return;
+    obj->FreeHead = qMEM_NONE;
+    if(obj->BlockSize < (qSize_t)(2u*sizeof(uint16_t)) || 0u != (obj->BlockSize & 1u) || 0u != ((size_t)obj->Blocks & 1u)) obj->NumberofBlocks = 0u; /*the free blocks can't hold the aligned free-list links, leave the pool empty (every allocation fails)*/
+    memset(obj->FreeMap, 0, (((uint32_t)obj->NumberofBlocks + 31u)>>5)*sizeof(uint32_t)); /*the bits past the last block stay cleared (never free)*/
+    _qMemoryMapUpdate(obj, 0u, obj->NumberofBlocks, qTrue);
+    for(i = obj->NumberofBlocks; i > 0u; i--) _qMemoryFreeListPush(obj, (uint16_t)(i - 1u)); /*the lower blocks first*/
+    #ifdef Q_MEMORY_STATS
+    memset(&obj->Stats, 0, sizeof(qMemoryStats_t));
+    #endif
+}
+/*============================================================================*/
+static void _qMemoryFreeListPush(qMemoryPool_t *obj, const uint16_t Index){
+    _qMemLinkPrev(obj, Index) = qMEM_NONE;
+    _qMemLinkNext(obj, Index) = obj->FreeHead;
+    if(qMEM_NONE != obj->FreeHead) _qMemLinkPrev(obj, obj->FreeHead) = Index;
+    obj->FreeHead = Index;
+}
+/*============================================================================*/
+static void _qMemoryFreeListUnlink(qMemoryPool_t *obj, const uint16_t Index){
+    uint16_t next = _qMemLinkNext(obj, Index), prev = _qMemLinkPrev(obj, Index);
+    if(qMEM_NONE != prev) _qMemLinkNext(obj, prev) = next;
+    else obj->FreeHead = next;
+    if(qMEM_NONE != next) _qMemLinkPrev(obj, next) = prev;
+}
+/*============================================================================*/
+static void _qMemoryMapUpdate(qMemoryPool_t *obj, uint16_t Index, uint16_t nBlocks, const qBool_t Free){ /*set or clear a range of bits in the free-map*/
+    uint32_t mask, *word;
+    uint8_t bit, n;
+    while(nBlocks > 0u){
+        word = &obj->FreeMap[Index>>5];
+        bit = (uint8_t)(Index & 31u);
+        n = (nBlocks > (uint16_t)(32u - bit))? (uint8_t)(32u - bit) : (uint8_t)nBlocks;
+        mask = (32u == n)? 0xFFFFFFFFul : ((((uint32_t)1ul << n) - 1u) << bit);
+        if(Free) *word |= mask;
+        else *word &= ~mask;
+        Index += n;
+        nBlocks -= n;
+    }
+}
+/*============================================================================*/
+static uint16_t _qMemoryFindRun(qMemoryPool_t *obj, const uint16_t nBlocks){ /*first-fit search of <nBlocks> contiguous free blocks on the free-map*/
+    uint32_t word, m, nWords, w, run = 0u, start = 0u;
+    uint16_t len, sh;
+    nWords = ((uint32_t)obj->NumberofBlocks + 31u)>>5;
+    for(w = 0u; w < nWords; w++){
+        word = obj->FreeMap[w];
+        if(0u == word){ /*all the blocks of this word are in use*/
+            run = 0u;
+            continue;
+        }
+        if(0xFFFFFFFFul == word){ /*all the blocks of this word are free*/
+            if(0u == run) start = w<<5;
+            run += 32u;
+            if(run >= nBlocks) return (uint16_t)start;
+            continue;
+        }
+        if(run > 0u && (run + _qMemory_ctz(~word)) >= nBlocks) return (uint16_t)start; /*the run from the previous words ends in this one*/
+        if(nBlocks < 32u){ /*look for the run inside the word : bit i stays set only if the bits i..i+nBlocks-1 are all set*/
+            m = word;
+            for(len = 1u; len < nBlocks; len += sh){
+                sh = ((nBlocks - len) < len)? (uint16_t)(nBlocks - len) : len;
+                m &= m >> sh;
+            }
+            if(0u != m) return (uint16_t)((w<<5) + _qMemory_ctz(m));
+        }
+        run = _qMemory_clz(~word); /*the free blocks at the top of the word can start a run*/
+        start = (w<<5) + 32u - run;
+    }
+    return qMEM_NONE;
+}
+/*============================================================================*/
+static uint8_t _qMemory_clz(uint32_t x){ /*count leading zeros, <x> must not be zero*/
+    #if defined(__GNUC__)
+        return (uint8_t)__builtin_clz(x);
+    #else
+        uint8_t n = 0u;
+        if(0u == (x & 0xFFFF0000ul)){ x <<= 16; n += 16u; }
+        if(0u == (x & 0xFF000000ul)){ x <<= 8; n += 8u; }
+        if(0u == (x & 0xF0000000ul)){ x <<= 4; n += 4u; }
+        if(0u == (x & 0xC0000000ul)){ x <<= 2; n += 2u; }
+        if(0u == (x & 0x80000000ul)){ n += 1u; }
+        return n;
+    #endif
+}
+/*============================================================================*/
+static uint8_t _qMemory_ctz(uint32_t x){ /*count trailing zeros, <x> must not be zero*/
+    #if defined(__GNUC__)
+        return (uint8_t)__builtin_ctz(x);
+    #else
+        uint8_t n = 0u;
+        if(0u == (x & 0x0000FFFFul)){ x >>= 16; n += 16u; }
+        if(0u == (x & 0x000000FFul)){ x >>= 8; n += 8u; }
+        if(0u == (x & 0x0000000Ful)){ x >>= 4; n += 4u; }
+        if(0u == (x & 0x00000003ul)){ x >>= 2; n += 2u; }
+        if(0u == (x & 0x00000001ul)){ n += 1u; }
+        return n;
+    #endif
+}
+/*============================================================================*/
+/*void* qMemoryAlloc(qMemoryPool_t *obj, uint16_t size)
+ 
+Allocate the required memory from the specified memory heap. The allocation 
+is rounded to the memory block size. The returned memory is zero-initialized.
+Allocations that fit in a single block are taken from the free-list in constant
+time, larger ones take the first run of contiguous free blocks found on the
+free-map of the pool.
+ 
+Parameters:
+
+    - obj : a pointer to the memory pool object
+    - size : amount of memory to allocate
+ 
+Return value:
+
+    A pointer to allocated memory or null if there is not available memory
+ */
+void* qMemoryAlloc(qMemoryPool_t *obj, const qSize_t size){
+    uint16_t i, j, k;
+    uint8_t *offset = NULL;
+    if(NULL==obj) return NULL;			
+    qEnterCritical();
+    if(size <= obj->BlockSize){ /*fixed-block path : pop the head of the free-list*/
+        if(qMEM_NONE != obj->FreeHead){
+            j = obj->FreeHead;
+            _qMemoryFreeListUnlink(obj, j);
+            _qMemMapClear(obj, j);
+            *(obj->BlockDescriptors+j) = 1u; /*leave the record*/
+            offset = _qMemBlock(obj, j);
+        }
+        _qMemoryStatsAlloc(obj, size, (NULL != offset)? 1u : 0u);
+        qExitCritical();
+        if(NULL != offset) memset(offset, 0, obj->BlockSize); /*zero-initialized memory block*/
+        return (void*)offset;
+    }
+    k = (uint16_t)(((uint32_t)size + obj->BlockSize - 1u) / obj->BlockSize); /*the number of blocks required*/
+    j = (k <= obj->NumberofBlocks)? _qMemoryFindRun(obj, k) : qMEM_NONE;
+    if(qMEM_NONE != j){ /*memory area found*/
+        *(obj->BlockDescriptors+j) = k; /*leave the record*/
+        _qMemoryMapUpdate(obj, j, k, qFalse);
+        for(i = j; i < (uint16_t)(j + k); i++) _qMemoryFreeListUnlink(obj, i); /*the blocks are not available anymore for the fixed-block path*/
+        offset = _qMemBlock(obj, j);
+    }
+    _qMemoryStatsAlloc(obj, size, (NULL != offset)? k : 0u);
+    qExitCritical();
+    if(NULL != offset) memset(offset, 0, size); /*zero-initialized memory block*/ 
+    return (void*)offset; /*null if the memory is not available*/
+}
+/*============================================================================*/
+/*void* qMemoryFree(qMemoryPool_t *obj, void* pmem)
  
 Free the previously allocated memory by returning it to the specified memory pool.
  
 Parameters:
 
-    - obj : a pointer to the memory pool object
-    - pmem : pointer to the previously allocated memory
- 
-Note: The memory must be returned to the pool from where was allocated
- */
-void qMemoryFree(qMemoryPool_t *obj, void* pmem){
-    uint8_t i, *p;
-    if(NULL==obj || NULL==pmem) return;
-    qEnterCritical();	
-    p = obj->Blocks;
-    for(i = 0; i < obj->NumberofBlocks; i++) {
-        if( p == pmem ){
-            *(obj->BlockDescriptors + i) = 0;
-            break;
-	    }
-	    p += obj->BlockSize;
+    - obj : a pointer to the memory pool object
+    - pmem : pointer to the previously allocated memory
+ 
+Note: The memory must be returned to the pool from where was allocated
+ */
+void qMemoryFree(qMemoryPool_t *obj, void* pmem){
+    uint32_t offset;
+    uint16_t i, k;
+    if(NULL==obj || NULL==pmem) return;
+    if((uint8_t*)pmem < obj->Blocks) return; /*not from this pool*/
+    offset = (uint32_t)((uint8_t*)pmem - obj->Blocks);
+    if(offset >= (uint32_t)obj->NumberofBlocks*obj->BlockSize || 0u != (offset % obj->BlockSize)) return; /*not a block of this pool*/
+    i = (uint16_t)(offset / obj->BlockSize); /*the block index from the address*/
+    qEnterCritical();	
+    k = *(obj->BlockDescriptors + i);
+    *(obj->BlockDescriptors + i) = 0;
+    _qMemoryStatsFree(obj, k);
+    _qMemoryMapUpdate(obj, i, k, qTrue);
+    while(k > 0u) _qMemoryFreeListPush(obj, (uint16_t)(i + (--k))); /*return the blocks to the free-list (none if it was already free)*/
+    qExitCritical();
+}
+#ifdef Q_MEMORY_STATS
+/*============================================================================*/
+static void _qMemoryStatsAlloc(qMemoryPool_t *obj, const qSize_t size, const uint16_t nBlocks){
+    uint32_t x = (size > 1u)? (uint32_t)size - 1u : 0u;
+    uint8_t bin = 0u;
+    while(x > 0u){ x >>= 1; bin++; } /*ceil(log2(size))*/
+    obj->Stats.Histogram[bin]++;
+    if(0u == nBlocks){
+        obj->Stats.Failures++;
+        if((uint32_t)(obj->NumberofBlocks - obj->Stats.BlocksInUse)*obj->BlockSize >= size) obj->Stats.FragmentationFailures++; /*enough memory, but not contiguous*/
+        return;
+    }
+    obj->Stats.Allocations++;
+    obj->Stats.BlocksInUse += nBlocks;
+    if(obj->Stats.BlocksInUse > obj->Stats.PeakBlocksInUse) obj->Stats.PeakBlocksInUse = obj->Stats.BlocksInUse;
+}
+/*============================================================================*/
+/*qBool_t qMemoryGetStats(qMemoryPool_t *obj, qMemoryStats_t *Stats)
+
+Get a snapshot of the memory pool instrumentation. The largest run of 
+contiguous free blocks is computed on this call.
+
+Parameters:
+
+    - obj : a pointer to the memory pool object
+    - Stats : A pointer to the qMemoryStats_t structure where the statistics 
+              will be copied.
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse.
+*/
+qBool_t qMemoryGetStats(qMemoryPool_t *obj, qMemoryStats_t *Stats){
+    uint16_t i, run = 0u, largest = 0u;
+    if(NULL==obj || NULL==Stats) return qFalse;
+    qEnterCritical();
+    for(i = 0u; i < obj->NumberofBlocks; ){ /*walk the descriptors, skipping the allocated runs*/
+        if(0u != obj->BlockDescriptors[i]){
+            run = 0u;
+            i += obj->BlockDescriptors[i];
+        }
+        else{
+            if(++run > largest) largest = run;
+            i++;
+        }
+    }
+    obj->Stats.LargestFreeRun = largest;
+    *Stats = obj->Stats;
+    qExitCritical();
+    return qTrue;
+}
+/*============================================================================*/
+/*void qMemoryResetStats(qMemoryPool_t *obj)
+
+Clears the counters and the histogram of the memory pool instrumentation. The 
+blocks in use are kept, and the peak is restarted from this value.
+
+Parameters:
+
+    - obj : a pointer to the memory pool object
+*/
+void qMemoryResetStats(qMemoryPool_t *obj){
+    uint16_t InUse;
+    if(NULL==obj) return;
+    qEnterCritical();
+    InUse = obj->Stats.BlocksInUse;
+    memset(&obj->Stats, 0, sizeof(qMemoryStats_t));
+    obj->Stats.BlocksInUse = obj->Stats.PeakBlocksInUse = InUse;
+    qExitCritical();
+}
+/*============================================================================*/
+/*void qMemoryTraceStats(qMemoryPool_t *obj)
+
+Prints out the memory pool instrumentation through the debug/trace output 
+(see qSetDebugFcn). Only the non-empty bins of the histogram are printed, 
+where Bin is the ceil(log2()) of the requested size.
+
+Parameters:
+
+    - obj : a pointer to the memory pool object
+*/
+void qMemoryTraceStats(qMemoryPool_t *obj){
+    #ifdef Q_TRACE_VARIABLES
+    qMemoryStats_t Stats;
+    uint32_t BlocksInUse, PeakBlocksInUse, LargestFreeRun, TotalBlocks, Allocations, Frees, Failures, FragmentationFailures, Bin, Requests;
+    if(!qMemoryGetStats(obj, &Stats)) return;
+    TotalBlocks = obj->NumberofBlocks;
+    BlocksInUse = Stats.BlocksInUse;
+    PeakBlocksInUse = Stats.PeakBlocksInUse;
+    LargestFreeRun = Stats.LargestFreeRun;
+    Allocations = Stats.Allocations;
+    Frees = Stats.Frees;
+    Failures = Stats.Failures;
+    FragmentationFailures = Stats.FragmentationFailures;
+    qTraceVariable(TotalBlocks, UnsignedDecimal);
+    qTraceVariable(BlocksInUse, UnsignedDecimal);
+    qTraceVariable(PeakBlocksInUse, UnsignedDecimal);
+    qTraceVariable(LargestFreeRun, UnsignedDecimal);
+    qTraceVariable(Allocations, UnsignedDecimal);
+    qTraceVariable(Frees, UnsignedDecimal);
+    qTraceVariable(Failures, UnsignedDecimal);
+    qTraceVariable(FragmentationFailures, UnsignedDecimal);
+    for(Bin = 0u; Bin < Q_MEMORY_HISTOGRAM_BINS; Bin++){
+        if(0u == (Requests = Stats.Histogram[Bin])) continue;
+        qTraceVariable(Bin, UnsignedDecimal);
+        qTraceVariable(Requests, UnsignedDecimal);
+    }
+    #else
+    (void)obj;
+    #endif
+}
+#endif
+/*============================================================================*/
+/*qBool_t qMallocSetup(qMemoryPool_t **Pools, uint8_t NumberOfPools)
+
+Setup the size-class allocator used by qMalloc and qFree. Every pool is a size 
+class, and the requests are served from the smallest class whose block size 
+fits the requested size (if the class is exhausted, the next bigger class is 
+used).
+
+Parameters:
+
+    - Pools : An array of pointers to the memory pools (see qMemoryHeapCreate) 
+              sorted by block size in ascending order 
+              (i.e. 16B, 32B, 64B, 256B, 1024B).
+    - NumberOfPools : Number of elements of the <Pools> array 
+                      (max Q_MALLOC_MAX_CLASSES).
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse.
+*/
+qBool_t qMallocSetup(qMemoryPool_t **Pools, const uint8_t NumberOfPools){
+    uint8_t i, n;
+    if(NULL==Pools || 0u==NumberOfPools || NumberOfPools > Q_MALLOC_MAX_CLASSES) return qFalse;
+    for(i=0u;i<NumberOfPools;i++){
+        if(NULL==Pools[i]) return qFalse;
+        if(i>0u && Pools[i]->BlockSize <= Pools[i-1u]->BlockSize) return qFalse; /*the classes must be sorted*/
+    }
+    for(i=0u;i<NumberOfPools;i++) _qMallocClasses_.Pools[i] = Pools[i];
+    _qMallocClasses_.NumberOfPools = NumberOfPools;
+    for(n=0u, i=0u; n<=_qMalloc_MaxLog2; n++){ /*build the lookup table : request size rounded up to the power of two -> class*/
+        while(i<NumberOfPools && (uint32_t)Pools[i]->BlockSize < ((uint32_t)1u<<n)) i++;
+        _qMallocClasses_.ClassOf[n] = (i<NumberOfPools)? i : (uint8_t)(NumberOfPools - 1u); /*bigger than any class : contiguous blocks of the biggest class*/
+    }
+    return qTrue;
+}
+/*============================================================================*/
+/*void* qMalloc(qSize_t size)
+
+Allocate memory from the size-class allocator (see qMallocSetup). The class 
+is picked in constant time from the requested size. The returned memory is 
+zero-initialized.
+
+Parameters:
+
+    - size : amount of memory to allocate
+
+Return value:
+
+    A pointer to allocated memory or null if there is not available memory
+*/
+void* qMalloc(const qSize_t size){
+    uint32_t x = (size > 1u)? (uint32_t)size - 1u : 0u;
+    uint8_t log2 = 0u, i;
+    void *ptr = NULL;
+    if(0u == _qMallocClasses_.NumberOfPools) return NULL;
+    while(x >= 16u){ x >>= 4; log2 += 4u; } /*ceil(log2(size)) in a bounded number of steps*/
+    while(x > 0u){ x >>= 1; log2++; }
+    for(i = _qMallocClasses_.ClassOf[log2]; i < _qMallocClasses_.NumberOfPools && NULL == ptr; i++) ptr = qMemoryAlloc(_qMallocClasses_.Pools[i], size);
+    return ptr;
+}
+/*============================================================================*/
+/*void qFree(void *ptr)
+
+Free the memory previously allocated with qMalloc. The owner pool is found by
+address range.
+
+Parameters:
+
+    - ptr : pointer to the previously allocated memory
+*/
+void qFree(void *ptr){
+    qMemoryPool_t *pool;
+    uint8_t i;
+    if(NULL==ptr) return;
+    for(i=0u;i<_qMallocClasses_.NumberOfPools;i++){
+        pool = _qMallocClasses_.Pools[i];
+        if((uint8_t*)ptr >= pool->Blocks && (uint8_t*)ptr < pool->Blocks + (uint32_t)pool->NumberofBlocks*pool->BlockSize){
+            qMemoryFree(pool, ptr);
+            break;
+        }
+    }
+}
+/*============================================================================*/
+#endif
+
+#ifdef Q_MESSAGES
+/*============================================================================*/
+/*void* qMessageAlloc(qMemoryPool_t *Pool, qSize_t Size)
+
+Allocates a reference-counted message from the specified memory pool. The
+message is created with one reference, owned by the caller. Each task that 
+receives the message through qTaskSendMessage or qTaskQueueMessage gets its own
+reference, which is dropped automatically by the scheduler after the consuming
+dispatch. The message returns to its pool when the last reference is dropped,
+so the same buffer can be shared by several tasks without copies.
+
+Example:
+
+    Frame = qMessageAlloc(&FramePool, sizeof(Frame_t));
+    ...fill the frame...
+    qTaskSendMessage(&FilterTask, Frame);
+    qTaskQueueMessage(&LoggerTask, Frame);
+    qMessageRelease(Frame); (the producer is done with the frame)
+
+Parameters:
+
+    - Pool : a pointer to the memory pool object
+    - Size : the size of the message payload
+
+Return value:
+
+    A pointer to the message payload, or NULL if there is not available memory.
+*/
+void* qMessageAlloc(qMemoryPool_t *Pool, const qSize_t Size){
+    _qMessage_t *Msg;
+    if(NULL==Pool || Size > (qSize_t)((qSize_t)(~(qSize_t)0) - sizeof(_qMessage_t))) return NULL;
+    Msg = (_qMessage_t*)qMemoryAlloc(Pool, (qSize_t)(Size + sizeof(_qMessage_t)));
+    if(NULL==Msg) return NULL;
+    Msg->Pool = Pool;
+    _qAtomic_Store(&Msg->RefCount, 1u); /*the reference of the producer*/
+    return (void*)(Msg + 1);
+}
+/*============================================================================*/
+/*void* qMessageRetain(void *Msg)
+
+Adds a reference to the message. A task that needs to keep a received message
+beyond its dispatch must retain it and release it later with qMessageRelease.
+
+Parameters:
+
+    - Msg : a pointer to the message payload (see qMessageAlloc)
+
+Return value:
+
+    The same message pointer.
+*/
+void* qMessageRetain(void *Msg){
+    if(NULL==Msg) return NULL;
+    (void)_qMessage_RefAdd(&_qMessage_FromPtr(Msg)->RefCount, 1u);
+    return Msg;
+}
+/*============================================================================*/
+/*void qMessageRelease(void *Msg)
+
+Drops a reference of the message. When the last reference is dropped, the 
+message returns to the memory pool where it was allocated.
+
+Parameters:
+
+    - Msg : a pointer to the message payload (see qMessageAlloc)
+*/
+void qMessageRelease(void *Msg){
+    _qMessage_t *Header;
+    if(NULL==Msg) return;
+    Header = _qMessage_FromPtr(Msg);
+    if(0u == _qMessage_RefAdd(&Header->RefCount, 0xFFFFFFFFul)) qMemoryFree(Header->Pool, (void*)Header); /*the last reference*/
+}
+/*============================================================================*/
+/*uint32_t qMessageRefCount(const void *Msg)
+
+Returns the number of references of the message.
+
+Parameters:
+
+    - Msg : a pointer to the message payload (see qMessageAlloc)
+
+Return value:
+
+    The number of references of the message.
+*/
+uint32_t qMessageRefCount(const void *Msg){
+    if(NULL==Msg) return 0u;
+    return _qAtomic_Load(&((const _qMessage_t*)((const uint8_t*)Msg - sizeof(_qMessage_t)))->RefCount);
+}
+/*============================================================================*/
+/*qBool_t qTaskSendMessage(qTask_t *Task, void *Msg)
+
+Sends a reference-counted message as an asynchronous event (see qTaskSendEvent).
+A reference is added for the receiving task and is dropped after the task 
+gets dispatched with the "byAsyncEvent" trigger, the message will be available
+inside the EventData field. If the task still has an undelivered message, it
+gets replaced and its reference is dropped.
+
+Parameters:
+
+    - Task : Pointer to the task node.
+    - Msg : a pointer to the message payload (see qMessageAlloc)
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse.
+*/
+qBool_t qTaskSendMessage(qTask_t *Task, void *Msg){
+    if(NULL==Task || NULL==Msg) return qFalse;
+    qMessageRetain(Msg);
+    qMessageRelease(_qTask_SetAsyncData(Task, Msg, qTrue));
+    _qScheduler_Notify();
+    return qTrue;
+}
+/*============================================================================*/
+/*qBool_t qTaskQueueMessage(qTask_t *Task, void *Msg)
+
+Inserts a reference-counted message in the FIFO priority queue (see 
+qTaskQueueEvent). A reference is added for the receiving task and is dropped 
+after the task gets dispatched with the "byQueueExtraction" trigger, the 
+message will be available inside the EventData field.
+
+Parameters:
+
+    - Task : Pointer to the task node.
+    - Msg : a pointer to the message payload (see qMessageAlloc)
+
+Return value:
+
+    Returns qTrue if the message has been inserted in the queue, or qFalse if 
+    an error occurred (The queue exceeds the size).
+*/
+qBool_t qTaskQueueMessage(qTask_t *Task, void *Msg){
+    #ifdef Q_PRIORITY_QUEUE
+        if(NULL==Msg) return qFalse;
+        qMessageRetain(Msg);
+        if(_qScheduler_PriorityQueueInsert(Task, Msg, qTrue)) return qTrue;
+        qMessageRelease(Msg); /*not queued, give back the reference*/
+        return qFalse;
+    #else
+        (void)Task;
+        (void)Msg;
+        return qFalse;
+    #endif
+}
+/*============================================================================*/
+static void* _qTask_SetAsyncData(qTask_t *Task, void *Data, const qBool_t IsMessage){ /*returns the undelivered message replaced by the new event (if any)*/
+    void *Replaced = NULL;
+    qEnterCritical();
+    if(Task->Flag[_qIndex_AsyncRun] && Task->Flag[_qIndex_AsyncMsg]) Replaced = Task->AsyncData;
+    Task->AsyncData = Data;
+    Task->Flag[_qIndex_AsyncMsg] = IsMessage;
+    Task->Flag[_qIndex_AsyncRun] = qTrue;
+    qExitCritical();
+    return Replaced;
+}
+/*============================================================================*/
+static uint32_t _qMessage_RefAdd(volatile uint32_t *RefCount, const uint32_t Delta){ /*atomic add, returns the new value*/
+    uint32_t Expected = _qAtomic_Load(RefCount);
+    while(!_qAtomic_CAS(RefCount, &Expected, Expected + Delta)){}
+    return Expected + Delta;
+}
+#endif
+
+#ifdef Q_CONCURRENT_POOLS
+/*============================================================================*/
+/*qBool_t qConcurrentPoolInit(qConcurrentPool_t *Pool, void *Area, size_t BlockSize, uint32_t NumberOfBlocks)
+
+Initializes a concurrent memory pool of fixed-size blocks that can be shared 
+between threads without any lock. The free blocks are kept in a lock-free 
+shared free-list (the head is tagged to avoid the ABA problem), and every 
+thread keeps a small cache (magazine) of free blocks, so most of the 
+allocations and frees never touch the shared state.
+
+Parameters:
+
+    - Pool : A pointer to the concurrent pool object.
+    - Area : A pointer to the memory region of <NumberOfBlocks>*<BlockSize> 
+             bytes, aligned to 4 bytes.
+    - BlockSize : The size of each block (multiple of 4).
+    - NumberOfBlocks : Number of blocks.
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse.
+*/
+qBool_t qConcurrentPoolInit(qConcurrentPool_t *Pool, void *Area, const size_t BlockSize, const uint32_t NumberOfBlocks){
+    uint32_t i;
+    if(NULL==Pool || NULL==Area || 0u==NumberOfBlocks || NumberOfBlocks>=qCPOOL_NONE) return qFalse;
+    if(BlockSize < sizeof(uint32_t) || 0u != (BlockSize % sizeof(uint32_t)) || 0u != ((size_t)Area % sizeof(uint32_t))) return qFalse;
+    Pool->Blocks = (uint8_t*)Area;
+    Pool->BlockSize = BlockSize;
+    Pool->NumberOfBlocks = NumberOfBlocks;
+    for(i = 0u; i < NumberOfBlocks - 1u; i++) *_qCPool_Link(Pool, i) = i + 1u;
+    *_qCPool_Link(Pool, NumberOfBlocks - 1u) = qCPOOL_NONE;
+    __atomic_store_n(&Pool->Head, (uint64_t)0u, __ATOMIC_RELEASE); /*tag 0, first block 0*/
+    return qTrue;
+}
+/*============================================================================*/
+/*void* qConcurrentPoolAlloc(qConcurrentPool_t *Pool)
+
+Allocate a block from the concurrent pool. This API is thread-safe and 
+lock-free. The returned memory is not initialized.
+
+Parameters:
+
+    - Pool : A pointer to the concurrent pool object.
+
+Return value:
+
+    A pointer to allocated block or null if there is not available memory
+*/
+void* qConcurrentPoolAlloc(qConcurrentPool_t *Pool){
+    _qCPoolMagazine_t *Mag;
+    uint32_t Index;
+    if(NULL==Pool) return NULL;
+    Mag = _qCPool_Magazine(Pool);
+    if(NULL != Mag && Mag->Count > 0u) Index = Mag->Blocks[--Mag->Count]; /*fast path : from the thread cache*/
+    else{
+        if(qCPOOL_NONE == (Index = _qCPool_Pop(Pool))) return NULL; /*memory not available*/
+        if(NULL != Mag){ /*refill half of the thread cache for the next allocations*/
+            uint32_t Extra;
+            while(Mag->Count < (Q_CPOOL_MAGAZINE_SIZE/2u) && qCPOOL_NONE != (Extra = _qCPool_Pop(Pool))) Mag->Blocks[Mag->Count++] = Extra;
+        }
+    }
+    return (void*)(Pool->Blocks + (size_t)Index*Pool->BlockSize);
+}
+/*============================================================================*/
+/*void qConcurrentPoolFree(qConcurrentPool_t *Pool, void *ptr)
+
+Return a block to the concurrent pool. This API is thread-safe and lock-free. 
+The block can be released from a thread different from the one that 
+allocated it.
+
+Parameters:
+
+    - Pool : A pointer to the concurrent pool object.
+    - ptr : pointer to the previously allocated block
+*/
+void qConcurrentPoolFree(qConcurrentPool_t *Pool, void *ptr){
+    _qCPoolMagazine_t *Mag;
+    size_t offset;
+    uint32_t Index, i;
+    if(NULL==Pool || NULL==ptr || (uint8_t*)ptr < Pool->Blocks) return;
+    offset = (size_t)((uint8_t*)ptr - Pool->Blocks);
+    Index = (uint32_t)(offset / Pool->BlockSize); /*the block index from the address*/
+    if(Index >= Pool->NumberOfBlocks || 0u != (offset % Pool->BlockSize)) return; /*not a block of this pool*/
+    Mag = _qCPool_Magazine(Pool);
+    if(NULL == Mag){
+        _qCPool_PushChain(Pool, Index, Index);
+        return;
+    }
+    if(Q_CPOOL_MAGAZINE_SIZE == Mag->Count){ /*the thread cache is full : return the older half to the shared list with a single CAS*/
+        for(i = 0u; i < (Q_CPOOL_MAGAZINE_SIZE/2u) - 1u; i++) __atomic_store_n(_qCPool_Link(Pool, Mag->Blocks[i]), Mag->Blocks[i + 1u], __ATOMIC_RELAXED);
+        _qCPool_PushChain(Pool, Mag->Blocks[0], Mag->Blocks[(Q_CPOOL_MAGAZINE_SIZE/2u) - 1u]);
+        for(i = 0u; i < (Q_CPOOL_MAGAZINE_SIZE/2u); i++) Mag->Blocks[i] = Mag->Blocks[i + (Q_CPOOL_MAGAZINE_SIZE/2u)];
+        Mag->Count = Q_CPOOL_MAGAZINE_SIZE/2u;
+    }
+    Mag->Blocks[Mag->Count++] = Index;
+}
+/*============================================================================*/
+/*void qConcurrentPoolFlushCache(qConcurrentPool_t *Pool)
+
+Returns the blocks cached by the calling thread to the shared free-list of the
+pool. A thread must call this API before exiting, otherwise its cached blocks 
+are lost.
+
+Parameters:
+
+    - Pool : A pointer to the concurrent pool object.
+*/
+void qConcurrentPoolFlushCache(qConcurrentPool_t *Pool){
+    uint32_t i;
+    for(i = 0u; i < Q_CPOOL_MAGAZINE_SLOTS; i++){
+        if(Pool == _qCPoolMagazines_[i].Pool){
+            while(_qCPoolMagazines_[i].Count > 0u){
+                _qCPoolMagazines_[i].Count--;
+                _qCPool_PushChain(Pool, _qCPoolMagazines_[i].Blocks[_qCPoolMagazines_[i].Count], _qCPoolMagazines_[i].Blocks[_qCPoolMagazines_[i].Count]);
+            }
+            _qCPoolMagazines_[i].Pool = NULL; /*release the slot*/
+            break;
+        }
+    }
+}
+/*============================================================================*/
+static _qCPoolMagazine_t* _qCPool_Magazine(qConcurrentPool_t *Pool){ /*get the cache of the calling thread for this pool*/
+    uint32_t i;
+    _qCPoolMagazine_t *Free = NULL;
+    for(i = 0u; i < Q_CPOOL_MAGAZINE_SLOTS; i++){
+        if(Pool == _qCPoolMagazines_[i].Pool) return &_qCPoolMagazines_[i];
+        if(NULL == Free && NULL == _qCPoolMagazines_[i].Pool) Free = &_qCPoolMagazines_[i];
+    }
+    if(NULL != Free){ /*first use of this pool in the calling thread*/
+        Free->Pool = Pool;
+        Free->Count = 0u;
+    }
+    return Free; /*NULL if all the slots are in use : no cache for this pool*/
+}
+/*============================================================================*/
+static uint32_t _qCPool_Pop(qConcurrentPool_t *Pool){
+    uint64_t Old, New;
+    uint32_t Index;
+    Old = __atomic_load_n(&Pool->Head, __ATOMIC_ACQUIRE);
+    do{
+        Index = (uint32_t)(Old & 0xFFFFFFFFul);
+        if(qCPOOL_NONE == Index) return qCPOOL_NONE; /*the shared list is empty*/
+        New = (((Old >> 32) + 1u) << 32) | (uint64_t)__atomic_load_n(_qCPool_Link(Pool, Index), __ATOMIC_RELAXED); /*the link may be stale if another thread took the block, but then the tag changed and the CAS fails*/
+    }while(!__atomic_compare_exchange_n(&Pool->Head, &Old, New, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    return Index;
+}
+/*============================================================================*/
+static void _qCPool_PushChain(qConcurrentPool_t *Pool, const uint32_t First, const uint32_t Last){ /*the blocks from <First> to <Last> must be already linked*/
+    uint64_t Old, New;
+    Old = __atomic_load_n(&Pool->Head, __ATOMIC_RELAXED);
+    do{
+        __atomic_store_n(_qCPool_Link(Pool, Last), (uint32_t)(Old & 0xFFFFFFFFul), __ATOMIC_RELAXED);
+        New = (((Old >> 32) + 1u) << 32) | (uint64_t)First;
+    }while(!__atomic_compare_exchange_n(&Pool->Head, &Old, New, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+#endif
+#ifdef Q_ARENA
+/*============================================================================*/
+/*qBool_t qArenaInit(qArena_t *Arena, void *Area, size_t Size)
+
+Initializes an arena (bump-pointer) allocator over the given memory area. The 
+allocations are just a pointer increment, and there is no individual free : 
+the memory is released all at once with qArenaReset, or back to a previously 
+saved point with qArenaRestore.
+
+Parameters:
+
+    - Arena : A pointer to the arena object.
+    - Area : A pointer to the memory region (i.e. a static array).
+    - Size : The size of the memory region in bytes.
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse.
+*/
+qBool_t qArenaInit(qArena_t *Arena, void *Area, const size_t Size){
+    if(NULL==Arena || NULL==Area || 0u==Size) return qFalse;
+    Arena->Area = (uint8_t*)Area;
+    Arena->Size = Size;
+    Arena->Offset = 0u;
+    return qTrue;
+}
+/*============================================================================*/
+/*void* qArenaAlloc(qArena_t *Arena, size_t size)
+
+Allocate memory from the arena. The returned memory is aligned to the machine 
+word and it is not initialized.
+
+Parameters:
+
+    - Arena : A pointer to the arena object.
+    - size : amount of memory to allocate
+
+Return value:
+
+    A pointer to allocated memory or null if there is not available memory
+*/
+void* qArenaAlloc(qArena_t *Arena, const size_t size){
+    size_t start;
+    if(NULL==Arena || 0u==size) return NULL;
+    start = (size_t)(Arena->Area + Arena->Offset);
+    start = ((start + (sizeof(size_t) - 1u)) & ~(sizeof(size_t) - 1u)) - (size_t)Arena->Area; /*align the offset*/
+    if(start > Arena->Size || size > Arena->Size - start) return NULL; /*memory not available*/
+    Arena->Offset = start + size;
+    return (void*)(Arena->Area + start);
+}
+/*============================================================================*/
+/*qArenaMark_t qArenaSave(const qArena_t *Arena)
+
+Get a save-point of the arena. All the memory allocated after this point can 
+be released at once with qArenaRestore.
+
+Parameters:
+
+    - Arena : A pointer to the arena object.
+
+Return value:
+
+    The save-point.
+*/
+qArenaMark_t qArenaSave(const qArena_t *Arena){
+    if(NULL==Arena) return 0u;
+    return (qArenaMark_t)Arena->Offset;
+}
+/*============================================================================*/
+/*void qArenaRestore(qArena_t *Arena, qArenaMark_t Mark)
+
+Releases all the memory allocated after the save-point.
+
+Parameters:
+
+    - Arena : A pointer to the arena object.
+    - Mark : The save-point obtained with qArenaSave.
+*/
+void qArenaRestore(qArena_t *Arena, const qArenaMark_t Mark){
+    if(NULL==Arena) return;
+    if(Mark <= Arena->Offset) Arena->Offset = (size_t)Mark; /*a save-point can only go back*/
+}
+/*============================================================================*/
+/*void qArenaReset(qArena_t *Arena)
+
+Releases all the memory allocated from the arena.
+
+Parameters:
+
+    - Arena : A pointer to the arena object.
+*/
+void qArenaReset(qArena_t *Arena){
+    if(NULL==Arena) return;
+    Arena->Offset = 0u;
+}
+/*============================================================================*/
+/*size_t qArenaAvailable(const qArena_t *Arena)
+
+Get the amount of memory that can still be allocated from the arena 
+(without the alignment padding).
+
+Parameters:
+
+    - Arena : A pointer to the arena object.
+
+Return value:
+
+    The available memory in bytes.
+*/
+size_t qArenaAvailable(const qArena_t *Arena){
+    if(NULL==Arena) return 0u;
+    return Arena->Size - Arena->Offset;
+}
+/*============================================================================*/
+/*void qSchedulerSetScratchArena(qArena_t *Arena)
+
+Set the scheduler scratch arena. The scratch arena is reset after every task 
+(or idle task) dispatch, so the callbacks can take temporary buffers from it 
+(see qSchedulerGetScratchArena) that live only until the callback returns.
+
+Parameters:
+
+    - Arena : A pointer to the arena object. Pass NULL to disable the scratch 
+              arena.
+*/
+void qSchedulerSetScratchArena(qArena_t *Arena){
+    _qScratchArena_ = Arena;
+    qArenaReset(Arena);
+}
+/*============================================================================*/
+/*qArena_t* qSchedulerGetScratchArena(void)
+
+Get the scheduler scratch arena (see qSchedulerSetScratchArena).
+
+Return value:
+
+    A pointer to the scratch arena or NULL if not set.
+*/
+qArena_t* qSchedulerGetScratchArena(void){
+    return _qScratchArena_;
+}
+#endif
+#ifdef Q_TLSF_HEAP
+/*============================================================================*/
+/*qBool_t qTLSFHeapInit(qTLSFHeap_t *Heap, void *Area, size_t Size)
+
+Initializes a Two-Level Segregated Fit (TLSF) heap over the given memory area.
+The TLSF heap serves variable-size allocations in constant time (O(1) for both 
+allocation and free), and the free blocks are immediately coalesced with their 
+neighbors. If the interrupts enabler/disabler are set with 
+qSchedulerSetInterruptsED, the heap operations are protected by a critical 
+section, so the heap can be shared with the ISRs.
+
+Parameters:
+
+    - Heap : A pointer to the TLSF heap object.
+    - Area : A pointer to the memory region (i.e. a static array).
+    - Size : The size of the memory region in bytes.
+
+Return value:
+
+    Returns qTrue on success, otherwise returns qFalse (the region is too small
+    or too big for Q_TLSF_FL_INDEX_MAX).
+*/
+qBool_t qTLSFHeapInit(qTLSFHeap_t *Heap, void *Area, const size_t Size){
+    _qTLSFBlock_t *Block, *Next;
+    size_t skip, bytes;
+    if(NULL==Heap || NULL==Area) return qFalse;
+    memset(Heap, 0, sizeof(qTLSFHeap_t));
+    skip = _qTLSF_AlignUp((size_t)Area) - (size_t)Area; /*the payloads must be word aligned*/
+    if(Size < skip + 2u*_qTLSF_OVERHEAD + _qTLSF_BLOCK_SIZE_MIN) return qFalse;
+    bytes = _qTLSF_AlignDown(Size - skip - 2u*_qTLSF_OVERHEAD); /*the main block and the sentinel headers*/
+    if(bytes < _qTLSF_BLOCK_SIZE_MIN || bytes >= _qTLSF_BLOCK_SIZE_MAX) return qFalse;
+    Block = (_qTLSFBlock_t*)((uint8_t*)Area + skip - sizeof(_qTLSFBlock_t*)); /*the PrevPhys field of the first block is never accessed*/
+    Block->Size = bytes | _qTLSF_FREE_BIT; /*the previous block is in use*/
+    _qTLSF_InsertFree(Heap, Block);
+    Next = _qTLSF_LinkNext(Block); /*the sentinel : a zero-sized used block*/
+    Next->Size = _qTLSF_PREVFREE_BIT;
+    return qTrue;
+}
+/*============================================================================*/
+/*void* qTLSFAlloc(qTLSFHeap_t *Heap, size_t size)
+
+Allocate memory from the TLSF heap in constant time. The memory is not 
+initialized.
+
+Parameters:
+
+    - Heap : A pointer to the TLSF heap object.
+    - size : amount of memory to allocate
+
+Return value:
+
+    A pointer to allocated memory or null if there is not available memory
+*/
+void* qTLSFAlloc(qTLSFHeap_t *Heap, const size_t size){
+    _qTLSFBlock_t *Block, *Remaining;
+    size_t adjusted;
+    uint8_t fl, sl;
+    if(NULL==Heap || 0u==size || size >= _qTLSF_BLOCK_SIZE_MAX) return NULL;
+    adjusted = _qTLSF_AlignUp(size);
+    if(adjusted < _qTLSF_BLOCK_SIZE_MIN) adjusted = _qTLSF_BLOCK_SIZE_MIN;
+    fl = sl = 0u;
+    if(adjusted >= _qTLSF_SMALL_BLOCK_SIZE) _qTLSF_Mapping(adjusted + (((size_t)1u << (_qTLSF_fls((uint32_t)adjusted) - Q_TLSF_SL_INDEX_LOG2)) - 1u), &fl, &sl); /*round-up to the next list, so any block of that list fits (good-fit)*/
+    else _qTLSF_Mapping(adjusted, &fl, &sl);
+    if(fl >= (uint8_t)_qTLSF_FL_COUNT) return NULL;
+    qEnterCritical();
+    if(NULL == (Block = _qTLSF_SearchSuitable(Heap, &fl, &sl))){
+        qExitCritical();
+        return NULL; /*memory not available*/
+    }
+    _qTLSF_RemoveFree(Heap, Block, fl, sl);
+    if(_qTLSF_Size(Block) >= sizeof(_qTLSFBlock_t) + adjusted){ /*split the block, the remaining part goes back to the free lists*/
+        Remaining = (_qTLSFBlock_t*)((uint8_t*)_qTLSF_ToPtr(Block) + adjusted - _qTLSF_OVERHEAD);
+        Remaining->Size = _qTLSF_Size(Block) - (adjusted + _qTLSF_OVERHEAD);
+        _qTLSF_SetSize(Block, adjusted);
+        _qTLSF_MarkAsFree(Remaining);
+        _qTLSF_LinkNext(Block);
+        Remaining->Size |= _qTLSF_PREVFREE_BIT;
+        _qTLSF_InsertFree(Heap, Remaining);
+    }
+    _qTLSF_Next(Block)->Size &= ~_qTLSF_PREVFREE_BIT; /*mark as used*/
+    Block->Size &= ~_qTLSF_FREE_BIT;
+    qExitCritical();
+    return _qTLSF_ToPtr(Block);
+}
+/*============================================================================*/
+/*void qTLSFFree(qTLSFHeap_t *Heap, void *ptr)
+
+Return the memory to the TLSF heap in constant time. The block is merged with
+its free neighbors.
+
+Parameters:
+
+    - Heap : A pointer to the TLSF heap object.
+    - ptr : pointer to the previously allocated memory
+*/
+void qTLSFFree(qTLSFHeap_t *Heap, void *ptr){
+    _qTLSFBlock_t *Block, *Next;
+    if(NULL==Heap || NULL==ptr) return;
+    Block = _qTLSF_FromPtr(ptr);
+    if(_qTLSF_IsFree(Block)) return; /*double free*/
+    qEnterCritical();
+    _qTLSF_MarkAsFree(Block);
+    if(_qTLSF_IsPrevFree(Block)){ /*merge with the previous physical block*/
+        _qTLSF_Remove(Heap, Block->PrevPhys);
+        Block = _qTLSF_Absorb(Block->PrevPhys, Block);
+    }
+    Next = _qTLSF_Next(Block);
+    if(_qTLSF_IsFree(Next)){ /*merge with the next physical block*/
+        _qTLSF_Remove(Heap, Next);
+        Block = _qTLSF_Absorb(Block, Next);
     }
+    _qTLSF_InsertFree(Heap, Block);
     qExitCritical();
 }
 /*============================================================================*/
+/*size_t qTLSFBlockSize(const void *ptr)
+
+Get the usable size of an allocated block.
+
+Parameters:
+
+    - ptr : pointer to the previously allocated memory
+
+Return value:
+
+    The usable size in bytes (at least the requested size).
+*/
+size_t qTLSFBlockSize(const void *ptr){
+    if(NULL==ptr) return 0u;
+    return _qTLSF_Size(_qTLSF_FromPtr(ptr));
+}
+/*============================================================================*/
+static uint8_t _qTLSF_fls(uint32_t x){ /*index of the most significant bit set*/
+    #if defined(__GNUC__)
+        return (uint8_t)(31 - __builtin_clz(x));
+    #else
+        uint8_t n = 0u;
+        if(x & 0xFFFF0000ul){ x >>= 16; n += 16u; }
+        if(x & 0x0000FF00ul){ x >>= 8; n += 8u; }
+        if(x & 0x000000F0ul){ x >>= 4; n += 4u; }
+        if(x & 0x0000000Cul){ x >>= 2; n += 2u; }
+        if(x & 0x00000002ul){ n += 1u; }
+        return n;
+    #endif
+}
+/*============================================================================*/
+static uint8_t _qTLSF_ffs(uint32_t x){ /*index of the least significant bit set*/
+    #if defined(__GNUC__)
+        return (uint8_t)__builtin_ctz(x);
+    #else
+        return _qTLSF_fls(x & (~x + 1u));
+    #endif
+}
+/*============================================================================*/
+static void _qTLSF_Mapping(size_t size, uint8_t *fl, uint8_t *sl){ /*get the list that holds the blocks of this size*/
+    uint8_t f;
+    if(size < _qTLSF_SMALL_BLOCK_SIZE){ /*the small blocks are in the first list, linearly spaced*/
+        *fl = 0u;
+        *sl = (uint8_t)(size / (_qTLSF_SMALL_BLOCK_SIZE / _qTLSF_SL_COUNT));
+    }
+    else{
+        f = _qTLSF_fls((uint32_t)size);
+        *sl = (uint8_t)((size >> (f - Q_TLSF_SL_INDEX_LOG2)) ^ ((size_t)1u << Q_TLSF_SL_INDEX_LOG2));
+        *fl = (uint8_t)(f - (_qTLSF_FL_SHIFT - 1));
+    }
+}
+/*============================================================================*/
+static _qTLSFBlock_t* _qTLSF_SearchSuitable(qTLSFHeap_t *Heap, uint8_t *fl, uint8_t *sl){ /*two bitmap lookups at most*/
+    uint32_t map = Heap->SLBitmap[*fl] & (~(uint32_t)0u << *sl);
+    if(0u == map){ /*no block in this class, look in the next bigger classes*/
+        map = (*fl + 1u < 32u)? Heap->FLBitmap & (~(uint32_t)0u << (*fl + 1u)) : 0u;
+        if(0u == map) return NULL;
+        *fl = _qTLSF_ffs(map);
+        map = Heap->SLBitmap[*fl];
+    }
+    *sl = _qTLSF_ffs(map);
+    return Heap->Blocks[*fl][*sl];
+}
+/*============================================================================*/
+static void _qTLSF_RemoveFree(qTLSFHeap_t *Heap, _qTLSFBlock_t *Block, const uint8_t fl, const uint8_t sl){
+    if(NULL != Block->NextFree) Block->NextFree->PrevFree = Block->PrevFree;
+    if(NULL != Block->PrevFree) Block->PrevFree->NextFree = Block->NextFree;
+    if(Heap->Blocks[fl][sl] == Block){
+        Heap->Blocks[fl][sl] = Block->NextFree;
+        if(NULL == Block->NextFree){ /*the list is empty now, update the bitmaps*/
+            Heap->SLBitmap[fl] &= ~((uint32_t)1u << sl);
+            if(0u == Heap->SLBitmap[fl]) Heap->FLBitmap &= ~((uint32_t)1u << fl);
+        }
+    }
+}
+/*============================================================================*/
+static void _qTLSF_InsertFree(qTLSFHeap_t *Heap, _qTLSFBlock_t *Block){
+    uint8_t fl, sl;
+    _qTLSF_Mapping(_qTLSF_Size(Block), &fl, &sl);
+    Block->NextFree = Heap->Blocks[fl][sl];
+    Block->PrevFree = NULL;
+    if(NULL != Block->NextFree) Block->NextFree->PrevFree = Block;
+    Heap->Blocks[fl][sl] = Block;
+    Heap->FLBitmap |= (uint32_t)1u << fl;
+    Heap->SLBitmap[fl] |= (uint32_t)1u << sl;
+}
+/*============================================================================*/
+static void _qTLSF_Remove(qTLSFHeap_t *Heap, _qTLSFBlock_t *Block){
+    uint8_t fl, sl;
+    _qTLSF_Mapping(_qTLSF_Size(Block), &fl, &sl);
+    _qTLSF_RemoveFree(Heap, Block, fl, sl);
+}
+/*============================================================================*/
+static _qTLSFBlock_t* _qTLSF_LinkNext(_qTLSFBlock_t *Block){
+    _qTLSFBlock_t *Next = _qTLSF_Next(Block);
+    Next->PrevPhys = Block;
+    return Next;
+}
+/*============================================================================*/
+static void _qTLSF_MarkAsFree(_qTLSFBlock_t *Block){
+    _qTLSFBlock_t *Next = _qTLSF_LinkNext(Block);
+    Next->Size |= _qTLSF_PREVFREE_BIT;
+    Block->Size |= _qTLSF_FREE_BIT;
+}
+/*============================================================================*/
+static _qTLSFBlock_t* _qTLSF_Absorb(_qTLSFBlock_t *Prev, _qTLSFBlock_t *Block){
+    Prev->Size += _qTLSF_Size(Block) + _qTLSF_OVERHEAD;
+    _qTLSF_LinkNext(Prev);
+    return Prev;
+}
 #endif
 
 #ifdef Q_RINGBUFFERS
@@ -1234,15 +3643,34 @@ static qSize_t _qRBufferValidPowerOfTwo(qSize_t k){
     return k;
 }
 /*============================================================================*/
-static qSize_t _qRBufferCount(qRBuffer_t *obj){
-    return (qSize_t)(obj ? (obj->head - obj->tail) : 0);
+static qRBIndex_t _qRBufferDistance(const qRBuffer_t *obj, const qRBIndex_t head, const qRBIndex_t tail){ /*the number of elements from <tail> to <head> (SPSC indices)*/
+    return (head >= tail)? (qRBIndex_t)(head - tail) : (qRBIndex_t)(head + (qRBIndex_t)(2u*obj->Elementcount - tail));
+}
+/*============================================================================*/
+static qRBIndex_t _qRBufferAdvance(const qRBuffer_t *obj, const qRBIndex_t i, const qRBIndex_t n){ /*move the SPSC index <n> elements ahead, with a conditional subtract instead of modulo*/
+    qRBIndex_t room = (qRBIndex_t)(2u*obj->Elementcount - i); /*the indices run in [0, 2*Elementcount), so a full buffer can be told from an empty one*/
+    return (n >= room)? (qRBIndex_t)(n - room) : (qRBIndex_t)(i + n);
+}
+/*============================================================================*/
+static qRBIndex_t _qRBufferCount(qRBuffer_t *obj){
+    if(NULL==obj) return 0u;
+    #ifdef Q_RBUFFER_MPMC
+    if(_qRBufferIsMPMC(obj)) return (qRBIndex_t)(_qAtomic_Load(&obj->head) - _qAtomic_Load(&obj->tail)); /*free-running positions*/
+    #endif
+    #ifdef Q_RBUFFER_OVERWRITE
+    if(_qRBufferIsOverwrite(obj)){ /*the producer also moves the tail, so the two loads are only a snapshot*/
+        qRBIndex_t tail = _qAtomic_Load(&obj->tail), count = _qRBufferDistance(obj, _qAtomic_Load(&obj->head), tail);
+        return (count > obj->Elementcount)? obj->Elementcount : count;
+    }
+    #endif
+    return _qRBufferDistance(obj, _qAtomic_Load(&obj->head), _qAtomic_Load(&obj->tail));
 }
 /*============================================================================*/
 static qBool_t _qRBufferFull(qRBuffer_t *obj){
     return (qBool_t)(obj ? (qBool_t)(_qRBufferCount(obj) == obj->Elementcount) : qTrue);
 }
 /*============================================================================*/
-/*void qRBufferInit(qRBuffer_t *obj, void* DataBlock, uint16_t ElementSize, uint16_t ElementCount)
+/*void qRBufferInit(qRBuffer_t *obj, void* DataBlock, qSize_t ElementSize, qRBIndex_t ElementCount)
  
 Configures the ring buffer
  
@@ -1251,18 +3679,187 @@ Parameters:
     - obj : a pointer to the Ring Buffer object
     - DataBlock :  data block or array of data
     - ElementSize : size of one element in the data block
-    - ElementCount : Max number of elements in the buffer
- 
-Note: Element_count should be a power of two, or it will only use the next 
-      lower power of two
+    - ElementCount : Max number of elements in the buffer (any value, the 
+                     indices are wrapped with a conditional subtract)
+
+Note: One producer and one consumer can use the ring buffer concurrently (e.g.
+      a capture thread or an ISR and a task) without critical sections, the
+      indices are published with release/acquire ordering.
  */
-void qRBufferInit(qRBuffer_t *obj, void* DataBlock, const qSize_t ElementSize, const qSize_t ElementCount){
+void qRBufferInit(qRBuffer_t *obj, void* DataBlock, const qSize_t ElementSize, const qRBIndex_t ElementCount){
     if(NULL==obj || NULL==DataBlock) return;
     obj->head = 0;
     obj->tail = 0;
     obj->data = DataBlock;
     obj->ElementSize = ElementSize;
-    obj->Elementcount = _qRBufferValidPowerOfTwo(ElementCount); /*limit to a power of two, this allos a bit to be used to count the final slot*/
+    obj->Elementcount = (ElementCount > _qRBIndexMaxCount)? _qRBIndexMaxCount : ElementCount; /*the indices need twice the range of the count*/
+    #ifdef Q_RBUFFER_MPMC
+    obj->Sequences = NULL;
+    #endif
+    #ifdef Q_RBUFFER_OVERWRITE
+    obj->Overwrite = qFalse;
+    obj->Overwrites = 0u;
+    #endif
+}
+#ifdef Q_RBUFFER_MPMC
+/*============================================================================*/
+/*void qRBufferInitMPMC(qRBuffer_t *obj, void* DataBlock, volatile qRBIndex_t *Sequences, qSize_t ElementSize, qRBIndex_t ElementCount)
+ 
+Configures a ring buffer that can be shared by several producers and several
+consumers concurrently (threads, ISRs or tasks) without locks. Each slot has a
+sequence number that tells if it is free or holds an element, so the producers
+and the consumers only compete for the indices with a compare-and-swap.
+qRBufferPush, qRBufferPopFront, qRBufferEmpty and qRBufferGetFront keep their
+behavior, and the ring buffer can be linked to tasks with qTaskLinkRBuffer. On 
+qRB_AUTOPOP, the linked task takes the front element in place and the slot is 
+given back to the producers after the dispatch.
+
+Parameters:
+
+    - obj : a pointer to the Ring Buffer object
+    - DataBlock :  data block or array of data
+    - Sequences : array of <ElementCount> sequence numbers (one for each slot)
+    - ElementSize : size of one element in the data block
+    - ElementCount : Max number of elements in the buffer
+ 
+Note: Element_count should be a power of two, or it will only use the next 
+      lower power of two (the positions are free-running and the lap of each
+      slot must stay consistent when they overflow). The count is also limited 
+      to the largest power of two below the max count of the indices.
+
+Note: The bulk and in-place calls (qRBufferPushN, qRBufferPopN, qRBufferReserve, 
+      qRBufferCommit, qRBufferPeek and qRBufferRelease) are single-producer/
+      single-consumer only, and fail on this kind of ring buffers.
+ */
+void qRBufferInitMPMC(qRBuffer_t *obj, void* DataBlock, volatile qRBIndex_t *Sequences, const qSize_t ElementSize, const qRBIndex_t ElementCount){
+    qRBIndex_t i, n = 1u;
+    if(NULL==obj || NULL==DataBlock || NULL==Sequences || 0u==ElementCount) return;
+    while((qRBIndex_t)(n << 1) <= ElementCount && (qRBIndex_t)(n << 1) <= _qRBIndexMaxCount) n = (qRBIndex_t)(n << 1); /*the largest power of two that fits (also in the range of the indices)*/
+    qRBufferInit(obj, DataBlock, ElementSize, n);
+    for(i = 0u; i < obj->Elementcount; i++) Sequences[i] = i; /*every slot is free for the position <i>*/
+    obj->Sequences = Sequences;
+}
+/*============================================================================*/
+static void* _qRBufferClaimFront(qRBuffer_t *obj, qRBIndex_t *Pos){ /*take the ownership of the front slot, NULL if empty*/
+    qRBIndex_t pos = _qAtomic_Load(&obj->tail), seq, index;
+    for(;;){
+        index = (qRBIndex_t)(pos & (obj->Elementcount - 1u));
+        seq = _qAtomic_Load(&obj->Sequences[index]);
+        if(0 == _qRBIndexDiff(seq, pos + 1u)){ /*the slot holds the element of this position*/
+            if(_qRBufferCASIndex(&obj->tail, &pos, (qRBIndex_t)(pos + 1u))) break; /*claimed, otherwise <pos> gets the current tail*/
+        }
+        else if(_qRBIndexDiff(seq, pos + 1u) < 0) return NULL; /*the producer of this position hasn't finished yet : empty*/
+        else pos = _qAtomic_Load(&obj->tail); /*another consumer took it, retry*/
+    }
+    *Pos = pos;
+    return (void*)(obj->data + (size_t)index*obj->ElementSize);
+}
+/*============================================================================*/
+static void _qRBufferReleaseFront(qRBuffer_t *obj, const qRBIndex_t Pos){ /*the slot is free for the producer of the position Pos+Elementcount*/
+    _qAtomic_Store(&obj->Sequences[Pos & (obj->Elementcount - 1u)], (qRBIndex_t)(Pos + obj->Elementcount));
+}
+/*============================================================================*/
+static qBool_t _qRBufferPushMPMC(qRBuffer_t *obj, const void *data){
+    qRBIndex_t pos = _qAtomic_Load(&obj->head), seq, index;
+    for(;;){
+        index = (qRBIndex_t)(pos & (obj->Elementcount - 1u));
+        seq = _qAtomic_Load(&obj->Sequences[index]);
+        if(0 == _qRBIndexDiff(seq, pos)){ /*the slot is free for this position*/
+            if(_qRBufferCASIndex(&obj->head, &pos, (qRBIndex_t)(pos + 1u))) break; /*claimed, otherwise <pos> gets the current head*/
+        }
+        else if(_qRBIndexDiff(seq, pos) < 0) return qFalse; /*the consumer of the previous lap hasn't finished yet : full*/
+        else pos = _qAtomic_Load(&obj->head); /*another producer took it, retry*/
+    }
+    memcpy((void*)(obj->data + (size_t)index*obj->ElementSize), data, obj->ElementSize);
+    _qAtomic_Store(&obj->Sequences[index], (qRBIndex_t)(pos + 1u)); /*release: publish the element to the consumers*/
+    _qScheduler_Notify();
+    return qTrue;
+}
+#endif
+#ifdef Q_RBUFFER_OVERWRITE
+/*============================================================================*/
+/*void qRBufferInitOverwrite(qRBuffer_t *obj, void* DataBlock, qSize_t ElementSize, qRBIndex_t ElementCount)
+ 
+Configures an overwrite-oldest ring buffer, that always keeps the newest 
+<ElementCount> elements (telemetry or flight-recorder buffers). When the ring
+buffer is full, qRBufferPush drops the oldest element moving the tail with a
+compare-and-swap, so the push never fails for a full buffer and the producer 
+doesn't need to pop before. The dropped elements are counted (see 
+qRBufferGetOverwrites).
+
+Parameters:
+
+    - obj : a pointer to the Ring Buffer object
+    - DataBlock :  data block or array of data
+    - ElementSize : size of one element in the data block
+    - ElementCount : Max number of elements in the buffer
+
+Note: One producer and one consumer can use the ring buffer concurrently. The 
+      consumer also moves the tail with a compare-and-swap, so qRBufferPopFront 
+      retries the copy if the producer dropped the element in the meantime. 
+      The in-place accesses (qRBufferGetFront and the qRB_AUTOPOP dispatch) can 
+      see the element being overwritten if the producer wraps around.
+
+Note: The bulk and in-place calls (qRBufferPushN, qRBufferPopN, qRBufferReserve, 
+      qRBufferCommit, qRBufferPeek and qRBufferRelease) fail on this kind of 
+      ring buffers.
+ */
+void qRBufferInitOverwrite(qRBuffer_t *obj, void* DataBlock, const qSize_t ElementSize, const qRBIndex_t ElementCount){
+    if(NULL==obj || NULL==DataBlock) return;
+    qRBufferInit(obj, DataBlock, ElementSize, ElementCount);
+    obj->Overwrite = qTrue;
+}
+/*============================================================================*/
+/*uint32_t qRBufferGetOverwrites(qRBuffer_t *obj)
+ 
+Returns the number of elements dropped by the producer of an overwrite-oldest 
+ring buffer since it was initialized.
+ 
+Parameters:
+
+    - obj : a pointer to the Ring Buffer object
+  
+Return value:
+
+    The number of overwritten elements (0 for the other ring buffers)
+ */
+uint32_t qRBufferGetOverwrites(qRBuffer_t *obj){
+    return (NULL==obj)? 0u : _qAtomic_Load(&obj->Overwrites);
+}
+#endif
+#if defined(Q_RBUFFER_MPMC) || defined(Q_RBUFFER_OVERWRITE)
+/*============================================================================*/
+static qBool_t _qRBufferCASIndex(volatile qRBIndex_t *Ptr, qRBIndex_t *Expected, const qRBIndex_t Desired){ /*the ring buffer index can be narrower than the fallback of the atomics*/
+    #if defined(_qAtomic_LockFree)
+    return (qBool_t)_qAtomic_CAS(Ptr, Expected, Desired);
+    #else
+    qBool_t RetValue;
+    qEnterCritical();
+    if((RetValue = (qBool_t)(*Ptr == *Expected))) *Ptr = Desired;
+    else *Expected = *Ptr;
+    qExitCritical();
+    return RetValue;
+    #endif
+}
+#endif
+/*============================================================================*/
+static void _qRBufferDropFront(qRBuffer_t *obj, const qRBIndex_t Tail){ /*remove the front element taken in place at <Tail>*/
+    #ifdef Q_RBUFFER_OVERWRITE
+    qRBIndex_t tail = Tail;
+    #endif
+    #ifdef Q_RBUFFER_MPMC
+    if(_qRBufferIsMPMC(obj)){
+        _qRBufferReleaseFront(obj, Tail);
+        return;
+    }
+    #endif
+    #ifdef Q_RBUFFER_OVERWRITE
+    if(_qRBufferIsOverwrite(obj)){
+        (void)_qRBufferCASIndex(&obj->tail, &tail, _qRBufferAdvance(obj, Tail, 1u)); /*fails if the producer already dropped it*/
+        return;
+    }
+    #endif
+    _qAtomic_Store(&obj->tail, _qRBufferAdvance(obj, Tail, 1u)); /*release: the slot can be reused by the producer*/
 }
 /*============================================================================*/
 /*qBool_t qRBufferEmpty(qRBuffer_t *obj)
@@ -1294,8 +3891,23 @@ Return value:
     Pointer to the data, or NULL if nothing in the list
  */
 void* qRBufferGetFront(qRBuffer_t *obj){
+    qRBIndex_t tail;
+    return _qRBufferFront(obj, &tail);
+}
+/*============================================================================*/
+static void* _qRBufferFront(qRBuffer_t *obj, qRBIndex_t *Tail){ /*the front element and the tail where it was found*/
+    qRBIndex_t tail;
     if (NULL==obj) return NULL;
-    return (void*)(!qRBufferEmpty(obj) ? &(obj->data[(obj->tail % obj->Elementcount) * obj->ElementSize]) : NULL);    
+    *Tail = tail = _qAtomic_Load(&obj->tail); /*only written by the consumer (SPSC)*/
+    #ifdef Q_RBUFFER_MPMC
+    if(_qRBufferIsMPMC(obj)){ /*only a hint : another consumer can take the element*/
+        tail = (qRBIndex_t)(tail & (obj->Elementcount - 1u));
+        if(_qAtomic_Load(&obj->Sequences[tail]) != (qRBIndex_t)(_qAtomic_Load(&obj->tail) + 1u)) return NULL;
+        return (void*)(obj->data + (size_t)tail*obj->ElementSize);
+    }
+    #endif
+    if(_qAtomic_Load(&obj->head) == tail) return NULL; /*acquire: the element is visible once the head says so*/
+    return (void*)(obj->data + (size_t)_qRBufferSlot(obj, tail)*obj->ElementSize);
 }
 /*============================================================================*/
 /*void* qRBufferPopFront(qRBuffer_t *obj)
@@ -1313,11 +3925,31 @@ Return value:
 */
 qBool_t qRBufferPopFront(qRBuffer_t *obj, void *dest){
     void *data = NULL;
+    qRBIndex_t tail;
     if(NULL==obj) return qFalse;
-    if (!qRBufferEmpty(obj)) {
-        data = (void*)(&(obj->data[(obj->tail % obj->Elementcount) * obj->ElementSize]));
+    #ifdef Q_RBUFFER_MPMC
+    if(_qRBufferIsMPMC(obj)){
+        if(NULL == (data = _qRBufferClaimFront(obj, &tail))) return qFalse;
         memcpy(dest, data, obj->ElementSize);
-        obj->tail++;
+        _qRBufferReleaseFront(obj, tail);
+        return qTrue;
+    }
+    #endif
+    #ifdef Q_RBUFFER_OVERWRITE
+    if(_qRBufferIsOverwrite(obj)){
+        for(;;){
+            tail = _qAtomic_Load(&obj->tail);
+            if(_qAtomic_Load(&obj->head) == tail) return qFalse; /*acquire: the element written by the producer is visible*/
+            memcpy(dest, (const void*)(obj->data + (size_t)_qRBufferSlot(obj, tail)*obj->ElementSize), obj->ElementSize);
+            if(_qRBufferCASIndex(&obj->tail, &tail, _qRBufferAdvance(obj, tail, 1u))) return qTrue; /*otherwise the producer dropped the element during the copy, take the new front*/
+        }
+    }
+    #endif
+    tail = obj->tail; /*only written by the consumer*/
+    if(_qAtomic_Load(&obj->head) != tail){ /*acquire: the element written by the producer is visible*/
+        data = (void*)(obj->data + (size_t)_qRBufferSlot(obj, tail)*obj->ElementSize);
+        memcpy(dest, data, obj->ElementSize);
+        _qAtomic_Store(&obj->tail, _qRBufferAdvance(obj, tail, 1u)); /*release: the slot is handed back to the producer after the copy*/
         return qTrue;
     }
     return qFalse;    
@@ -1338,21 +3970,208 @@ Return value:
 */
 qBool_t qRBufferPush(qRBuffer_t *obj, void *data){
     qBool_t status = qFalse;
-    uint8_t *data_element = (uint8_t*)data;
     volatile uint8_t *ring_data = NULL;
-    uint16_t i;
+    qRBIndex_t head;
 
     if(NULL==obj) return qFalse;
-    if(data_element){
-        if(!_qRBufferFull(obj)){ /*Limit the amount of elements to accpet*/
-            ring_data = obj->data + ((obj->head % obj->Elementcount) * obj->ElementSize);
-            for (i = 0; i < obj->ElementSize; i++) ring_data[i] = data_element[i];            
-            obj->head++;
+    #ifdef Q_RBUFFER_MPMC
+    if(_qRBufferIsMPMC(obj)) return (NULL != data)? _qRBufferPushMPMC(obj, data) : qFalse;
+    #endif
+    #ifdef Q_RBUFFER_OVERWRITE
+    if(_qRBufferIsOverwrite(obj) && NULL != data){
+        qRBIndex_t tail = _qAtomic_Load(&obj->tail);
+        head = obj->head; /*only written by the producer*/
+        if(_qRBufferDistance(obj, head, tail) == obj->Elementcount){ /*full : drop the oldest element*/
+            if(_qRBufferCASIndex(&obj->tail, &tail, _qRBufferAdvance(obj, tail, 1u))) _qAtomic_Store(&obj->Overwrites, obj->Overwrites + 1u); /*otherwise the consumer made room in the meantime*/
+        }
+        memcpy((void*)(obj->data + (size_t)_qRBufferSlot(obj, head)*obj->ElementSize), data, obj->ElementSize);
+        _qAtomic_Store(&obj->head, _qRBufferAdvance(obj, head, 1u)); /*release: the element is visible before the new head*/
+        _qScheduler_Notify();
+        return qTrue;
+    }
+    #endif
+    if(data){
+        head = obj->head; /*only written by the producer*/
+        if(_qRBufferDistance(obj, head, _qAtomic_Load(&obj->tail)) != obj->Elementcount){ /*Limit the amount of elements to accept (acquire: the consumer is done with the slot)*/
+            ring_data = obj->data + (size_t)_qRBufferSlot(obj, head)*obj->ElementSize;
+            memcpy((void*)ring_data, data, obj->ElementSize);
+            _qAtomic_Store(&obj->head, _qRBufferAdvance(obj, head, 1u)); /*release: the element is visible before the new head*/
+            _qScheduler_Notify();
             status = qTrue;
         }
     }
     return status;    
 }
+/*============================================================================*/
+/*qRBIndex_t qRBufferPushN(qRBuffer_t *obj, const void *data, qRBIndex_t n)
+ 
+Adds up to <n> elements of data to the ring buffer. The elements are copied
+with at most two memcpy calls (before and after the wrap-around) and the head 
+is updated once.
+ 
+Parameters:
+
+    - obj : a pointer to the Ring Buffer object
+    - data : a pointer to the array of elements who needs to be added 
+    - n : the number of elements to add
+  
+Return value:
+
+    The number of elements added (less than <n> if the ring buffer got full)
+*/
+qRBIndex_t qRBufferPushN(qRBuffer_t *obj, const void *data, const qRBIndex_t n){
+    qRBIndex_t head, count, index, first;
+    if(NULL==obj || _qRBufferIsShared(obj) || NULL==data) return 0u;
+    head = obj->head; /*only written by the producer*/
+    count = (qRBIndex_t)(obj->Elementcount - _qRBufferDistance(obj, head, _qAtomic_Load(&obj->tail))); /*the free slots (acquire: the consumer is done with them)*/
+    if(n < count) count = n;
+    if(0u == count) return 0u;
+    index = _qRBufferSlot(obj, head);
+    first = (qRBIndex_t)(obj->Elementcount - index); /*the slots until the wrap-around*/
+    if(first > count) first = count;
+    memcpy((void*)(obj->data + (size_t)index*obj->ElementSize), data, (size_t)first*obj->ElementSize);
+    memcpy((void*)obj->data, (const uint8_t*)data + (size_t)first*obj->ElementSize, (size_t)(count - first)*obj->ElementSize);
+    _qAtomic_Store(&obj->head, _qRBufferAdvance(obj, head, count)); /*release: the elements are visible before the new head*/
+    _qScheduler_Notify();
+    return count;
+}
+/*============================================================================*/
+/*qRBIndex_t qRBufferPopN(qRBuffer_t *obj, void *dest, qRBIndex_t n)
+ 
+Extracts up to <n> elements from the front of the ring buffer, and removes 
+them. The elements are copied with at most two memcpy calls (before and after 
+the wrap-around) and the tail is updated once.
+ 
+Parameters:
+
+    - obj : a pointer to the Ring Buffer object
+    - dest: pointer to where the data will be written (room for <n> elements)
+    - n : the max number of elements to extract
+  
+Return value:
+
+    The number of elements extracted (less than <n> if the ring buffer got empty)
+*/
+qRBIndex_t qRBufferPopN(qRBuffer_t *obj, void *dest, const qRBIndex_t n){
+    qRBIndex_t tail, count, index, first;
+    if(NULL==obj || _qRBufferIsShared(obj) || NULL==dest) return 0u;
+    tail = obj->tail; /*only written by the consumer*/
+    count = _qRBufferDistance(obj, _qAtomic_Load(&obj->head), tail); /*the available elements (acquire: the producer writes are visible)*/
+    if(n < count) count = n;
+    if(0u == count) return 0u;
+    index = _qRBufferSlot(obj, tail);
+    first = (qRBIndex_t)(obj->Elementcount - index); /*the elements until the wrap-around*/
+    if(first > count) first = count;
+    memcpy(dest, (const void*)(obj->data + (size_t)index*obj->ElementSize), (size_t)first*obj->ElementSize);
+    memcpy((uint8_t*)dest + (size_t)first*obj->ElementSize, (const void*)obj->data, (size_t)(count - first)*obj->ElementSize);
+    _qAtomic_Store(&obj->tail, _qRBufferAdvance(obj, tail, count)); /*release: the slots are handed back to the producer after the copy*/
+    return count;
+}
+/*============================================================================*/
+/*void* qRBufferReserve(qRBuffer_t *obj, qRBIndex_t *n)
+ 
+Gets a writable span of free slots directly in the ring buffer storage, so the 
+producer can build the elements in place. The span is contiguous, so it can be
+shorter than the free space if it reaches the wrap-around. The elements become 
+available to the consumer only after qRBufferCommit.
+ 
+Parameters:
+
+    - obj : a pointer to the Ring Buffer object
+    - n : [in] the number of elements wanted, [out] the number of elements in 
+          the returned span
+  
+Return value:
+
+    A pointer to the first free slot, or NULL if the ring buffer is full
+*/
+void* qRBufferReserve(qRBuffer_t *obj, qRBIndex_t *n){
+    qRBIndex_t head, count, index;
+    if(NULL==obj || _qRBufferIsShared(obj) || NULL==n) return NULL;
+    head = obj->head; /*only written by the producer*/
+    count = (qRBIndex_t)(obj->Elementcount - _qRBufferDistance(obj, head, _qAtomic_Load(&obj->tail))); /*the free slots (acquire: the consumer is done with them)*/
+    index = _qRBufferSlot(obj, head);
+    if(count > (qRBIndex_t)(obj->Elementcount - index)) count = (qRBIndex_t)(obj->Elementcount - index); /*only up to the wrap-around*/
+    if(count > *n) count = *n;
+    *n = count;
+    return (0u == count)? NULL : (void*)(obj->data + (size_t)index*obj->ElementSize);
+}
+/*============================================================================*/
+/*qBool_t qRBufferCommit(qRBuffer_t *obj, qRBIndex_t n)
+ 
+Makes available to the consumer the first <n> elements written in place after 
+qRBufferReserve.
+ 
+Parameters:
+
+    - obj : a pointer to the Ring Buffer object
+    - n : the number of elements written (at most the reserved ones)
+  
+Return value:
+
+    qTrue on success, qFalse if there is not enough free slots
+*/
+qBool_t qRBufferCommit(qRBuffer_t *obj, const qRBIndex_t n){
+    qRBIndex_t head;
+    if(NULL==obj || _qRBufferIsShared(obj)) return qFalse;
+    head = obj->head; /*only written by the producer*/
+    if(n > (qRBIndex_t)(obj->Elementcount - _qRBufferDistance(obj, head, _qAtomic_Load(&obj->tail)))) return qFalse;
+    _qAtomic_Store(&obj->head, _qRBufferAdvance(obj, head, n)); /*release: the elements are visible before the new head*/
+    _qScheduler_Notify();
+    return qTrue;
+}
+/*============================================================================*/
+/*void* qRBufferPeek(qRBuffer_t *obj, qRBIndex_t *n)
+ 
+Gets a readable span of elements directly in the ring buffer storage, so the 
+consumer can process them in place. The span is contiguous, so it can be 
+shorter than the available elements if it reaches the wrap-around. The 
+elements are not removed until qRBufferRelease.
+ 
+Parameters:
+
+    - obj : a pointer to the Ring Buffer object
+    - n : [in] the number of elements wanted, [out] the number of elements in 
+          the returned span
+  
+Return value:
+
+    A pointer to the front element, or NULL if the ring buffer is empty
+*/
+void* qRBufferPeek(qRBuffer_t *obj, qRBIndex_t *n){
+    qRBIndex_t tail, count, index;
+    if(NULL==obj || _qRBufferIsShared(obj) || NULL==n) return NULL;
+    tail = obj->tail; /*only written by the consumer*/
+    count = _qRBufferDistance(obj, _qAtomic_Load(&obj->head), tail); /*the available elements (acquire: the producer writes are visible)*/
+    index = _qRBufferSlot(obj, tail);
+    if(count > (qRBIndex_t)(obj->Elementcount - index)) count = (qRBIndex_t)(obj->Elementcount - index); /*only up to the wrap-around*/
+    if(count > *n) count = *n;
+    *n = count;
+    return (0u == count)? NULL : (void*)(obj->data + (size_t)index*obj->ElementSize);
+}
+/*============================================================================*/
+/*qBool_t qRBufferRelease(qRBuffer_t *obj, qRBIndex_t n)
+ 
+Removes the first <n> elements of the ring buffer after being processed in 
+place with qRBufferPeek. The slots are given back to the producer.
+ 
+Parameters:
+
+    - obj : a pointer to the Ring Buffer object
+    - n : the number of elements to remove
+  
+Return value:
+
+    qTrue on success, qFalse if there is not enough elements
+*/
+qBool_t qRBufferRelease(qRBuffer_t *obj, const qRBIndex_t n){
+    qRBIndex_t tail;
+    if(NULL==obj || _qRBufferIsShared(obj)) return qFalse;
+    tail = obj->tail; /*only written by the consumer*/
+    if(n > _qRBufferDistance(obj, _qAtomic_Load(&obj->head), tail)) return qFalse;
+    _qAtomic_Store(&obj->tail, _qRBufferAdvance(obj, tail, n)); /*release: the slots are handed back to the producer after processing*/
+    return qTrue;
+}
 #endif
 /*============================================================================*/
 /*void qSwapBytes(void *data, size_t n)
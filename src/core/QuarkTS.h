@@ -36,16 +36,44 @@ extern "C" {
     #ifndef __BYTE_ORDER__
         #define __BYTE_ORDER__  __ORDER_LITTLE_ENDIAN__
     #endif
+    #if defined(__GNUC__) && (2 == __GCC_ATOMIC_INT_LOCK_FREE) && (2 == __GCC_ATOMIC_SHORT_LOCK_FREE) && (__SIZEOF_INT__ >= 4)
+        #define _qAtomic_LockFree   /*native compare-and-swap (e.g. not on AVR or ARMv6-M, where the GCC atomics would need libatomic), otherwise the critical sections are used*/
+    #endif
     
     #define Q_BYTE_SIZED_BUFFERS    /*remove this line if you will never use the Byte-sized buffers*/
     #define Q_MEMORY_MANAGER        /*remove this line if you will never use the Memory Manager*/
+    #define Q_MEMORY_STATS          /*remove this line if you will never need the memory pools instrumentation*/
+    #define Q_MESSAGES              /*remove this line if you will never share reference-counted messages between tasks (requires the Memory Manager)*/
+    #if defined(__GNUC__) && defined(__linux__)
+    #define Q_CONCURRENT_POOLS      /*remove this line if you will never share memory pools between threads (hosted targets only : requires GCC atomics and thread-local storage)*/
+    #endif
+    #define Q_ARENA                 /*remove this line if you will never use the arena (bump-pointer) allocator*/
+    #define Q_TLSF_HEAP             /*remove this line if you will never use the TLSF heap (variable-size allocations)*/
+    /*#define Q_TLSF_FL_INDEX_MAX   24*/  /*uncomment this line to set the TLSF heap regions limit to 2^Q_TLSF_FL_INDEX_MAX bytes (by default 24, or 15 with a 16-bit size_t)*/
     #define Q_RINGBUFFERS           /*remove this line if you will never use Ring Buffers*/
+    #if defined(__linux__)
+    #define Q_RBUFFER_CACHE_LINE    64  /*the ring buffer indices are kept on separate cache lines of this size (remove this line on single-core targets)*/
+    #endif
+    #define Q_RBUFFER_32BIT_INDEX   /*ring buffers use 32-bit indices and counts (remove this line to use qSize_t indices, up to 32767 elements)*/
+    #if defined(_qAtomic_LockFree)
+    #define Q_RBUFFER_MPMC          /*remove this line if you will never share a ring buffer between several producers or consumers (enabled by default only with native compare-and-swap)*/
+    #endif
+    #define Q_RBUFFER_OVERWRITE     /*remove this line if you will never use the overwrite-oldest ring buffers (telemetry or flight-recorder buffers)*/
     #define Q_PRIORITY_QUEUE        /*remove this line if you will never queue events*/
     #define Q_AUTO_CHAINREARRANGE   /*remove this line if you will never change the tasks priorities dynamically */ 
     #define Q_TRACE_VARIABLES       /*remove this line if you will never need to debug variables*/
     #define Q_DEBUGTRACE_BUFSIZE    36  /*Size for the debug/trace buffer: 36 bytes should be enough*/
     #define Q_DEBUGTRACE_FULL       /*Full qTrace debug ouput*/
     #define Q_ATCOMMAND_PARSER      /*Command parser extension*/
+    #define Q_TASK_GROUPS           /*remove this line if you will never use task groups (fork-join)*/
+    #if defined(__linux__)
+    #define Q_FD_EVENTS             /*remove this line if you will never link file descriptors to tasks (Linux only)*/
+    #endif
+    #define Q_IDLE_WORK             /*remove this line if you will never use the idle-time deferred work queue*/
+    #define Q_DEFERRED_CALLS        /*remove this line if you will never defer calls from ISRs to the task context (lock-free only with native compare-and-swap)*/
+    #define Q_TIMER_SERVICE         /*remove this line if you will never use the callback timer service*/
+    #define Q_SCHEDULER_STATS       /*remove this line if you will never need the scheduler health statistics*/
+    /*#define Q_CR_COMPUTED_GOTO*/  /*uncomment this line to use the computed-goto coroutines (only if the compiler supports labels-as-values, measure it first: on out-of-order cores it is slower than the switch-based resume)*/
 
     #define Q_MAX_FTOA_PRECISION      10
     #undef QATOF_FULL
@@ -134,36 +162,56 @@ extern "C" {
     #define qMax(a,b)                                   (((a)>(b))?(a):(b))
     
     #ifdef _QUARKTS_CR_DEFS_
+        #if defined(Q_CR_COMPUTED_GOTO) && defined(__GNUC__) /*labels-as-values backend (GCC/Clang)*/
+            #define Q_CR_LABELS_AS_VALUES
+        #endif
         typedef int32_t _qTaskPC_t;
+        #ifdef Q_CR_LABELS_AS_VALUES
+        #define qCR_PCInitVal   (0)
+        #else
+        #define qCR_PCInitVal   (-0x7FFE)
+        #endif
         #define qCRPosition_t static _qTaskPC_t
         typedef struct {uint16_t head, tail;} qCoroutineSemaphore_t; 
         typedef qCoroutineSemaphore_t qCRSem_t;
-        #define qCR_PCInitVal   (-0x7FFE)           
         #define __qCRKeep
         #define __qCRCodeStartBlock      do
         #define __qCRCodeEndBlock        while(qFalse)
         #define __qPersistent            static _qTaskPC_t
-        #define __qTaskProgress          __LINE__
         #define __qAssert(_COND_)        if(!(_COND_))
-        #define __qTaskPCVar             _qCRTaskState_
+        #define __qTaskPCStorage         _qCRTaskPCStorage_
+        #define __qTaskPCVar             (*_qCRTaskState_)
+        #define __qTaskPCBind(_PTR_)     _qTaskPC_t * const _qCRTaskState_ = _PTR_
         #define __qSetPC(_VAL_)          __qTaskPCVar = _VAL_
         #define __qTaskSaveState         __qSetPC(__qTaskProgress) 
         #define __qTaskInitState         __qSetPC(qCR_PCInitVal) 
-        #define __qTaskCheckPCJump(_PC_) switch(_PC_){    
         #define __TagExitCCR             __qCRYield_ExitLabel
         #define __qExit                  goto __TagExitCCR
         #define __qTaskYield             __qExit;
+        #ifdef Q_CR_LABELS_AS_VALUES
+        #define __qCRLabelCat(_a_, _b_)  _a_##_b_
+        #define __qCRLabel(_line_)       __qCRLabelCat(__qCRResume_, _line_)
+        #define __TagStartCCR            __qCRResume_Begin
+        #define __qTaskProgress          ((_qTaskPC_t)(&&__qCRLabel(__LINE__) - &&__TagStartCCR)) /*label offset from the start point*/
+        #define __qTaskCheckPCJump(_PC_) goto *(&&__TagStartCCR + (_PC_)); {
+        #define __qCRDispose            __qTaskInitState;} __TagExitCCR:
+        #define __RestoreAfterYield      __qCRLabel(__LINE__):
+        #define __RestoreFromBegin       __TagStartCCR:
+        #else
+        #define __qTaskProgress          __LINE__
+        #define __qTaskCheckPCJump(_PC_) switch(_PC_){    
         #define __qCRDispose            __qTaskInitState;} __TagExitCCR:
         #define __qRestorator(_VAL_)     case (_qTaskPC_t)_VAL_:            
         #define __RestoreAfterYield      __qRestorator(__qTaskProgress)
         #define __RestoreFromBegin       __qRestorator(qCR_PCInitVal)
+        #endif
         #define __qCRSemInit(s, c)      __qCRCodeStartBlock{ (s)->tail = 0; (s)->head = (c); }__qCRCodeEndBlock
         #define __qCRSemCount(s)        ((s)->head - (s)->tail)
         #define __qCRSemLock(s)         (++(s)->tail)
         #define __qCRSemRelease(s)      (++(s)->head)
     #endif
 
-    typedef enum {qTriggerNULL, byTimeElapsed, byQueueExtraction, byAsyncEvent, byRBufferPop, byRBufferFull, byRBufferCount, byRBufferEmpty, bySchedulingRelease, byNoReadyTasks} qTrigger_t;
+    typedef enum {qTriggerNULL, byTimeElapsed, byQueueExtraction, byAsyncEvent, byRBufferPop, byRBufferFull, byRBufferCount, byRBufferEmpty, bySchedulingRelease, byNoReadyTasks, byFdReadable, byFdWritable} qTrigger_t;
     #define qTrigger_TimeElapsed        byTimeElapsed
     #define qTrigger_QueueExtraction    byQueueExtraction
     #define qTrigger_AsyncEvent         byAsyncEvent
@@ -173,6 +221,8 @@ extern "C" {
     #define qTrigger_RBufferEmpty       byRBufferEmpty
     #define qTrigger_SchedulingRelease  bySchedulingRelease
     #define qTrigger_NoReadyTasks       byNoReadyTasks
+    #define qTrigger_FdReadable         byFdReadable
+    #define qTrigger_FdWritable         byFdWritable
 
     typedef float qTime_t;
     typedef uint32_t qClock_t;
@@ -244,6 +294,14 @@ extern "C" {
                          RingBuffer will be available in the <EventData> field.
         
         - byNoReadyTasks: Only when the Idle Task is triggered.
+        
+        - byFdReadable: When the linked file descriptor is ready for reading 
+                        (or has been hung up). A pointer to the file descriptor
+                        (int) will be available in the <EventData> field.
+        
+        - byFdWritable: When the linked file descriptor is ready for writing. 
+                        A pointer to the file descriptor (int) will be available
+                        in the <EventData> field.
         */
         qTrigger_t Trigger;
         /* TaskData (Storage-Pointer):
@@ -286,6 +344,8 @@ extern "C" {
     #define _qIndex_RBFull          4
     #define _qIndex_RBCount         5
     #define _qIndex_RBEmpty         6
+    #define _qIndex_GroupPending    7
+    #define _qIndex_AsyncMsg        8
     
     typedef uint8_t qTaskState_t;
     #define qWaiting    0u
@@ -294,12 +354,35 @@ extern "C" {
     #define qSuspended  3u
 
     #ifdef Q_RINGBUFFERS 
-    typedef struct{
+    #ifdef Q_RBUFFER_32BIT_INDEX
+    typedef uint32_t qRBIndex_t; /*ring buffer indices and element counts*/
+    #else
+    typedef qSize_t qRBIndex_t;
+    #endif
+    typedef struct{ /*single-producer/single-consumer ring buffer : the producer only writes <head> and the consumer only writes <tail>*/
         volatile uint8_t *data; /* block of memory or array of data */
         volatile qSize_t ElementSize;      /* how many bytes for each chunk */
-        volatile qSize_t Elementcount;     /* number of chunks of data */
-        volatile qSize_t head; /* where the writes go */
-        volatile qSize_t tail; /* where the reads come from */
+        volatile qRBIndex_t Elementcount;     /* number of chunks of data */
+        #ifdef Q_RBUFFER_MPMC
+        volatile qRBIndex_t *Sequences; /* per-slot sequence numbers of the multi-producer/multi-consumer ring buffers (NULL otherwise) */
+        #endif
+        #ifdef Q_RBUFFER_OVERWRITE
+        qBool_t Overwrite; /* when full, the push drops the oldest element instead of failing (the producer also moves <tail>, with a compare-and-swap) */
+        #endif
+        #ifdef Q_RBUFFER_CACHE_LINE
+        uint8_t _pad0[Q_RBUFFER_CACHE_LINE]; /*the producer writes don't invalidate the line of the consumer and vice versa*/
+        #endif
+        #ifdef Q_RBUFFER_OVERWRITE
+        volatile uint32_t Overwrites; /* number of elements dropped by the producer (only written by the producer) */
+        #endif
+        volatile qRBIndex_t head; /* where the writes go */
+        #ifdef Q_RBUFFER_CACHE_LINE
+        uint8_t _pad1[Q_RBUFFER_CACHE_LINE - sizeof(qRBIndex_t)];
+        #endif
+        volatile qRBIndex_t tail; /* where the reads come from */
+        #ifdef Q_RBUFFER_CACHE_LINE
+        uint8_t _pad2[Q_RBUFFER_CACHE_LINE - sizeof(qRBIndex_t)];
+        #endif
     }qRBuffer_t;
     #endif
     
@@ -362,28 +445,76 @@ extern "C" {
     }qFSM_Attribute_t; 
           
     #define Q_TASK_EXTENDED_DATA
+    typedef struct{ /*the coroutine parking registers*/
+        volatile qClock_t Interval, ClockStart; /*time-epochs registers*/
+        volatile uint8_t State; /*the parking state (none, active or released by timeout)*/
+    }_qCRPark_t;
+    struct _qTaskGroup_t;
+    struct _qMemoryPool_t;
     struct _qTask_t{ /*Task node definition*/
         volatile struct _qTask_t *Next; /*pointer to the next node*/
         void *TaskData,*AsyncData; /*the storage pointers*/
         volatile qClock_t Interval, ClockStart; /*time-epochs registers*/
+        _qCRPark_t CRPark; /*the coroutine parking registers*/
+        _qTaskPC_t CRState; /*the per-task coroutine progress*/
         qIteration_t Iterations; 
         uint32_t Cycles; 
         qPriority_t Priority; 
         qTaskFcn_t Callback; 
-        volatile qBool_t Flag[7]; /*task related flags*/
+        volatile qBool_t Flag[9]; /*task related flags*/
         /*volatile qTaskFlags_t Flag;*/
         #ifdef Q_RINGBUFFERS
         qRBuffer_t *RingBuff; /*pointer to the linked RBuffer*/
         #endif
         qSM_t *StateMachine; /*pointer to the linked FSM*/
+        #ifdef Q_TASK_GROUPS
+        struct _qTaskGroup_t *Group; /*the task group where the task is a member*/
+        uint8_t GroupIndex; /*the member index inside the group*/
+        #endif
+        #ifdef Q_FD_EVENTS
+        int Fd; /*the linked file descriptor*/
+        volatile uint8_t FdEvents; /*the file descriptor events ready to be dispatched*/
+        #endif
         qTaskState_t State;
         qTrigger_t Trigger; 
     };
     #define qTask_t volatile struct _qTask_t
     typedef qTask_t** qHeadPointer_t;         
+    #ifdef Q_TASK_GROUPS
+    typedef struct _qTaskGroup_t{ /*Task group (fork-join) definition*/
+        qTask_t **Members; /*the member tasks*/
+        void **Results; /*the results collected from every member*/
+        qTask_t *JoinTask; /*the task launched when all the members complete*/
+        void *EventData; /*the user-data of the current fork*/
+        uint8_t NumberOfMembers;
+        volatile uint8_t Pending; /*number of members that haven't completed yet*/
+    }qTaskGroup_t;
+    #endif
+    #ifdef Q_IDLE_WORK
+    struct _qIdleWork_t;
+    typedef qBool_t (*qIdleWorkFcn_t)(struct _qIdleWork_t *);
+    typedef struct _qIdleWork_t{ /*Idle-time deferred work item*/
+        qIdleWorkFcn_t Fcn; /*the work function, returns qTrue when the work is done*/
+        void *Data; /*the work arguments*/
+        qClock_t Slice, SliceStart; /*time-epochs registers for the time slice*/
+        struct _qIdleWork_t *Next;
+        volatile uint8_t Pending;
+    }qIdleWork_t;
+    #endif
+    #ifdef Q_DEFERRED_CALLS
+    typedef void (*qDeferredFcn_t)(void *);
+    typedef struct{ /*Deferred call record*/
+        volatile uint32_t Sequence; /*the record turn (lock-free synchronization)*/
+        qDeferredFcn_t Fcn;
+        void *Arg;
+    }qDeferredCall_t;
+    #endif
     typedef struct{
         qTask_t *Task; /*the pointed task*/
         void *QueueData; 
+        #ifdef Q_MESSAGES
+        qBool_t IsMessage; /*the data is a reference-counted message*/
+        #endif
     }qQueueStack_t;  
 
     typedef struct{ /*Scheduler Core-Flags*/
@@ -391,6 +522,20 @@ extern "C" {
         volatile uint32_t IntFlags;
     }qTaskCoreFlags_t;
    
+    #ifdef Q_SCHEDULER_STATS
+    typedef struct{ /*Scheduler health statistics*/
+        uint32_t Cycles; /*number of scheduling cycles*/
+        uint32_t IdleDispatches; /*number of idle task dispatches (byNoReadyTasks)*/
+        uint32_t QueueExtractions; /*number of events extracted from the priority queue*/
+        uint32_t ReadyTasks; /*accumulated number of ready tasks dispatched from the chain (ReadyTasks/Cycles = ready tasks per cycle)*/
+        uint16_t MaxReadyTasks; /*max number of ready tasks found in a single cycle*/
+        qClock_t IdleEpochs, BusyEpochs; /*accumulated time-epochs the scheduler was idle or busy*/
+        qClock_t LastEpoch; /*time-epoch of the last accounting point*/
+        qClock_t Window; /*CPU load window in time-epochs*/
+        qClock_t WindowIdle, WindowBusy; /*time-epochs accounted in the current window*/
+        uint8_t CPULoad; /*CPU load of the last completed window [0-100]*/
+    }qSchedulerStats_t;
+    #endif
     typedef struct{ /*Main scheduler core data*/
         qTaskFcn_t IDLECallback;    
         qTaskFcn_t ReleaseSchedCallback;
@@ -405,8 +550,35 @@ extern "C" {
             uint8_t QueueSize; 
             volatile int16_t QueueIndex; /*holds the current queue index*/
             void *QueueData;
+            #ifdef Q_MESSAGES
+            qBool_t QueueMessage; /*the extracted data is a reference-counted message*/
+            #endif
         #endif 
         qTask_t *CurrentRunningTask;
+        qTask_t *ChainIterator; /*used to keep on track the current chain position*/
+        #ifdef Q_MEMORY_MANAGER
+            struct _qMemoryPool_t *TaskPool; /*the memory pool of the task nodes (see qTaskCreate)*/
+            qTask_t *TaskToReclaim; /*pooled task destroyed while running, released after its dispatch*/
+        #endif
+        #ifdef Q_DEFERRED_CALLS
+            qDeferredCall_t *DeferredCalls; /*the deferred call records (ring)*/
+            uint32_t DeferredMask;
+            volatile uint32_t DeferredEnqueue, DeferredDequeue; /*the producers and consumer positions*/
+        #endif
+        #ifdef Q_IDLE_WORK
+            qIdleWork_t *IdleWorkHead, *IdleWorkTail; /*the deferred work queue (FIFO)*/
+            qIdleWork_t *IdleWorkRunning; /*the work item out of the queue while its work function runs*/
+            qBool_t IdleWorkResubmit; /*the running item was submitted again from its work function*/
+        #endif
+        #ifdef Q_SCHEDULER_STATS
+            qSchedulerStats_t Stats;
+        #endif
+        #ifdef Q_FD_EVENTS
+            int FdPoller; /*the epoll instance*/
+            int FdWakeup; /*the eventfd used to wake-up the scheduler while it's blocked*/
+            uint8_t FdBlock; /*the scheduler can block waiting for file descriptor events*/
+            volatile uint8_t FdSleeping; /*the scheduler is (or is about to be) blocked waiting for file descriptor events*/
+        #endif
     }QuarkTSCoreData_t;
        
     qTime_t qClock2Time(const qClock_t t);
@@ -427,6 +599,18 @@ extern "C" {
                                 qSM_t *StateMachine, qSM_State_t InitState, qSM_SubState_t BeforeAnyState, qSM_SubState_t SuccessState, qSM_SubState_t FailureState, qSM_SubState_t UnexpectedState,
                                 qState_t InitialTaskState, void *arg);
     qBool_t qSchedulerRemoveTask(qTask_t *TasktoRemove);
+    #ifdef Q_SCHEDULER_STATS
+    #define Q_CPULOAD_DEFAULT_WINDOW    (1.0f) /*default CPU load window in seconds*/
+    qBool_t qSchedulerSetStatsWindow(const qTime_t Window);
+    qBool_t qSchedulerGetStats(qSchedulerStats_t *Stats);
+    uint8_t qSchedulerGetCPULoad(void);
+    void qSchedulerResetStats(void);
+    #endif
+    #ifdef Q_MEMORY_MANAGER
+    void _qInitTaskPool(struct _qMemoryPool_t *Pool, qTask_t *Area, uint16_t *Descriptors, uint32_t *FreeMap, const uint16_t Size);
+    qTask_t* qTaskCreate(qTaskFcn_t CallbackFcn, qPriority_t Priority, qTime_t Time, qIteration_t nExecutions, qState_t InitialState, void* arg);
+    qBool_t qTaskDestroy(qTask_t *Task);
+    #endif
     void qSchedulerRun(void);
     qBool_t qTaskQueueEvent(qTask_t *Task, void* eventdata);  
     void qTaskSendEvent(qTask_t *Task, void* eventdata);
@@ -441,6 +625,31 @@ extern "C" {
     qBool_t qTaskLinkRBuffer(qTask_t *Task, qRBuffer_t *RingBuffer, const qRBLinkMode_t Mode, uint8_t arg);
     #endif
     
+    #ifdef Q_TASK_GROUPS
+    qBool_t qTaskGroupInit(qTaskGroup_t *Group, qTask_t **Members, void **Results, uint8_t NumberOfMembers, qTask_t *JoinTask);
+    qBool_t qTaskGroupStart(qTaskGroup_t *Group, void *eventdata);
+    qBool_t qTaskGroupSetResult(void *Result);
+    qBool_t qTaskGroupIsBusy(const qTaskGroup_t *Group);
+    #endif
+    
+    #ifdef Q_DEFERRED_CALLS
+    void _qInitDeferredCalls(qDeferredCall_t *Area, const uint32_t Size);
+    qBool_t qDeferredCall(qDeferredFcn_t Fcn, void *Arg);
+    #endif
+    #ifdef Q_IDLE_WORK
+    qBool_t qIdleWorkSubmit(qIdleWork_t *Work, qIdleWorkFcn_t Fcn, void *Data, const qTime_t Slice);
+    qBool_t qIdleWorkCancel(qIdleWork_t *Work);
+    qBool_t qIdleWorkIsPending(const qIdleWork_t *Work);
+    qBool_t qIdleWorkSliceExpired(const qIdleWork_t *Work);
+    #endif
+    
+    typedef enum{qFD_READABLE=0x01u, qFD_WRITABLE=0x02u, qFD_READWRITE=0x03u}qFdLinkMode_t;
+    #ifdef Q_FD_EVENTS
+    #define Q_FD_EVENTS_BATCH   64 /*max number of file descriptor events retrieved by the scheduler on every wait*/
+    qBool_t qTaskLinkFd(qTask_t *Task, int fd, const qFdLinkMode_t Mode, uint8_t arg);
+    void qSchedulerWakeup(void);
+    #endif
+    
     void qTaskSetTime(qTask_t *Task, const qTime_t Value);
     void qTaskSetIterations(qTask_t *Task, const qIteration_t Value);
     void qTaskSetPriority(qTask_t *Task, const qPriority_t Value);
@@ -493,18 +702,52 @@ Parameters:
     #else
         #define qSchedulerSetup(ISRTick, IDLE_Callback, QueueSize)                                   _qInitScheduler(ISRTick, IDLE_Callback, NULL, 0)
     #endif
+/*void qSchedulerSetupTaskPool(uint16_t N)
+    
+Creates the pool of task nodes (TCBs) used by qTaskCreate. This macro must be 
+called once in the application main thread after qSchedulerSetup.
+The nodes are managed by a memory pool with one block per task, it can be 
+obtained with qSchedulerGetTaskPool to inspect its usage (see qMemoryGetStats).
+
+Parameters:
+
+    - N : Max number of tasks that can be alive at the same time using qTaskCreate
+*/
+    #ifdef Q_MEMORY_MANAGER
+        #define qSchedulerSetupTaskPool(N)                                                           qTask_t _qTaskPoolArea[N]; uint16_t _qTaskPoolBDes[N]; uint32_t _qTaskPoolFMap[((N)+31)>>5]; qMemoryPool_t _qTaskPool; _qInitTaskPool(&_qTaskPool, _qTaskPoolArea, _qTaskPoolBDes, _qTaskPoolFMap, N)
+    #endif
+/*void qSchedulerSetupDeferredCalls(uint32_t N)
+    
+Creates the queue of deferred calls used by qDeferredCall. This macro must be 
+called once in the application main thread after qSchedulerSetup.
+
+Parameters:
+
+    - N : Max number of pending deferred calls. If N is not a power of two, 
+          the largest power of two below N is used.
+*/
+    #ifdef Q_DEFERRED_CALLS
+        #define qSchedulerSetupDeferredCalls(N)                                                      qDeferredCall_t _qDeferredCallsArea[N]; _qInitDeferredCalls(_qDeferredCallsArea, N)
+    #endif
     qBool_t qStateMachine_Init(qSM_t *obj, qSM_State_t InitState, qSM_SubState_t SuccessState, qSM_SubState_t FailureState, qSM_SubState_t UnexpectedState, qSM_SubState_t BeforeAnyState);
     void qStateMachine_Run(qSM_t *obj, void *Data);
     void qStateMachine_Attribute(qSM_t *obj, qFSM_Attribute_t Flag ,void *val);
     
     #ifdef _QUARKTS_CR_DEFS_    
-        #define __qCRStart                          __qPersistent  __qTaskInitState ;  __qTaskCheckPCJump(__qTaskPCVar) __RestoreFromBegin
+        #define __qCRStart                          __qPersistent  __qTaskPCStorage = qCR_PCInitVal; __qTaskPCBind(&__qTaskPCStorage); __qTaskCheckPCJump(__qTaskPCVar) __RestoreFromBegin
+        #define __qCRTaskStart                      __qTaskPCBind(_qCRTaskPCGet()); __qTaskCheckPCJump(__qTaskPCVar) __RestoreFromBegin
         #define __qCRYield                          __qCRCodeStartBlock{  __qTaskSaveState      ; __qTaskYield  __RestoreAfterYield; }                      __qCRCodeEndBlock
         #define __qCRRestart                        __qCRCodeStartBlock{  __qTaskInitState      ; __qTaskYield }                                            __qCRCodeEndBlock
         #define __qCR_wu_Assert(_cond_)             __qCRCodeStartBlock{  __qTaskSaveState      ; __RestoreAfterYield   ; __qAssert(_cond_) __qTaskYield }  __qCRCodeEndBlock
         #define __qCR_GetPosition(_pos_)            __qCRCodeStartBlock{  _pos_=__qTaskProgress ; __RestoreAfterYield   ;}                                  __qCRCodeEndBlock
         #define __qCR_RestoreFromPosition(_pos_)    __qCRCodeStartBlock{  __qSetPC(_pos_)       ; __qTaskYield}                                             __qCRCodeEndBlock
         #define __qCR_PositionReset(_pos_)          _pos_ = qCR_PCInitVal
+        #define __qCR_Park(_cond_, _t_)             __qCRCodeStartBlock{  _qCRParkTask(_t_)     ; __qTaskSaveState      ; __RestoreAfterYield   ; __qAssert(_qCRParkRelease(_cond_)) __qTaskYield }  __qCRCodeEndBlock
+        
+        _qTaskPC_t* _qCRTaskPCGet(void);
+        void _qCRParkTask(const qTime_t Time);
+        qBool_t _qCRParkRelease(const qBool_t Condition);
+        qBool_t _qCRParkTimeoutExpired(void);
 /*qCoroutineBegin{
   
 }qCoroutineEnd;
@@ -521,6 +764,23 @@ It must always be used together with a matching qCoroutineBegin statement.
 */
         #define qCoroutineBegin                         __qCRStart
         #define qCRBegin                                __qCRStart
+/*qCoroutineTaskBegin{
+  
+}qCoroutineEnd;
+
+qCRTaskBegin{
+  
+}qCREnd;
+
+Same as qCoroutineBegin, but the Coroutine progress is kept inside the running 
+task node instead of a static variable. This allows a single callback function 
+to drive several task instances, each one with its own Coroutine progress. 
+Per-instance data (that must persist between yields) should be placed in a 
+structure passed as the task argument (TaskData field).
+Only one Coroutine segment of this type is allowed per task.
+*/
+        #define qCoroutineTaskBegin                     __qCRTaskStart
+        #define qCRTaskBegin                            __qCRTaskStart
 /*qCoroutineYield
 qCRYield
 
@@ -561,6 +821,38 @@ Yields until the logical condition being true
 */    
         #define qCoroutineWaitUntil(_condition_)        __qCR_wu_Assert(_condition_)
         #define qCRWaitUntil(_condition_)               __qCR_wu_Assert(_condition_)
+/*qCoroutineDelay(_TIME_) 
+qCRDelay(_TIME_)
+
+Suspends the Coroutine for the specified time (in seconds). The task is parked 
+inside the scheduler, so it will not be dispatched by its own time-elapsed events 
+until the delay expires. Other events (async, queue or RBuffer) still launch the
+task, but the Coroutine keeps waiting until the delay expires.
+Inside the idle task, the Coroutine polls the delay each time the idle task 
+runs (like a qSTimer wait).
+*/  
+        #define qCoroutineDelay(_time_)                 __qCR_Park(qFalse, _time_)
+        #define qCRDelay(_time_)                        __qCR_Park(qFalse, _time_)
+/*qCoroutineWaitUntilTimeout(_CONDITION_, _TIME_) 
+qCRWaitUntilTimeout(_CONDITION_, _TIME_)
+
+Yields until the logical condition being true or the specified time (in seconds) 
+expires. The task is parked inside the scheduler, so the condition is only 
+re-evaluated when the task gets another event (async, queue or RBuffer) or when
+the timeout expires. Use qCoroutineTimeoutExpired() to check the outcome.
+Inside the idle task, the condition and the timeout are polled each time the 
+idle task runs (like a qSTimer wait).
+*/  
+        #define qCoroutineWaitUntilTimeout(_condition_, _time_)     __qCR_Park(_condition_, _time_)
+        #define qCRWaitUntilTimeout(_condition_, _time_)            __qCR_Park(_condition_, _time_)
+/*qCoroutineTimeoutExpired() 
+qCRTimeoutExpired()
+
+Returns qTrue if the last qCoroutineWaitUntilTimeout finished because the 
+timeout expired, or qFalse if the condition was met.
+*/  
+        #define qCoroutineTimeoutExpired()              _qCRParkTimeoutExpired()
+        #define qCRTimeoutExpired()                     _qCRParkTimeoutExpired()
 /*qCoroutineSemaphoreInit(_qCRSemaphore_t_, _Value_) 
 qCRSemInit(_qCRSemaphore_t_, _Value_)
 
@@ -640,16 +932,53 @@ Resets the _CRPos_ variable to the begining of the Co-Routine
         void qSTimerChangeTime(qSTimer_t *obj, const qTime_t Time);
         qBool_t qSTimerStatus(const qSTimer_t *obj);
         #define QSTIMER_INITIALIZER     {0, 0, 0}
+
+    #ifdef Q_TIMER_SERVICE
+        #define Q_TIMERWHEEL_LEVELS     4   /*number of levels of the timing wheel*/
+        #define Q_TIMERWHEEL_BITS       6   /*each level has 2^Q_TIMERWHEEL_BITS slots*/
+        struct _qCBTimer_t;
+        typedef void (*qCBTimerFcn_t)(struct _qCBTimer_t *);
+        typedef struct _qCBTimer_t{ /*Callback timer definition*/
+            qCBTimerFcn_t Callback; /*the function fired when the timer expires*/
+            void *Data; /*the timer arguments*/
+            qClock_t Expiry, Period; /*time-epochs registers*/
+            struct _qCBTimer_t *Next, **PrevNext; /*the wheel slot links (O(1) removal)*/
+            uint8_t Active;
+        }qCBTimer_t;
+        
+        qBool_t qCBTimerServiceStart(qTask_t *Task, qPriority_t Priority);
+        qBool_t qCBTimerStart(qCBTimer_t *Timer, qCBTimerFcn_t Callback, void *Data, const qTime_t Time, const qBool_t AutoReload);
+        qBool_t qCBTimerStop(qCBTimer_t *Timer);
+        qBool_t qCBTimerIsActive(const qCBTimer_t *Timer);
+        qClock_t qCBTimerRemaining(const qCBTimer_t *Timer);
+    #endif
      
         
 #ifdef Q_MEMORY_MANAGER
 /* This structure is the head of a memory pool. */
-typedef struct {
+#ifdef Q_MEMORY_STATS
+#define Q_MEMORY_HISTOGRAM_BINS     17 /*one bin per power of two of the requested size : [0]=1B, [1]=2B, [2]=3-4B, [3]=5-8B ... [16]=32KB-64KB*/
+typedef struct { /*Memory pool instrumentation*/
+    uint16_t BlocksInUse, PeakBlocksInUse; /*current and high-water mark of blocks in use*/
+    uint16_t LargestFreeRun; /*largest number of contiguous free blocks (only updated by qMemoryGetStats)*/
+    uint32_t Allocations, Frees; /*successful operations*/
+    uint32_t Failures; /*failed allocations*/
+    uint32_t FragmentationFailures; /*failed allocations while enough blocks were free, but not contiguous*/
+    uint32_t Histogram[Q_MEMORY_HISTOGRAM_BINS]; /*number of allocation requests by size*/
+}qMemoryStats_t;
+#endif
+typedef struct _qMemoryPool_t{
     qSize_t BlockSize;	
-    uint8_t NumberofBlocks;
-    uint8_t *BlockDescriptors;
+    uint16_t NumberofBlocks;
+    uint16_t *BlockDescriptors; /*the length of each allocated run, stored at its first block*/
+    uint32_t *FreeMap; /*one bit per block, set if the block is free*/
     uint8_t *Blocks;
+    uint16_t FreeHead; /*the first block of the free-list (the links are embedded in the free blocks)*/
+    #ifdef Q_MEMORY_STATS
+    qMemoryStats_t Stats;
+    #endif
 }qMemoryPool_t;        
+#define qMEM_NONE   (0xFFFFu)
         
 typedef enum {
     qMB_4B = 4, qMB_8B = 8, qMB_16B = 16, qMB_32B = 32, qMB_64B = 64, qMB_128B = 128,
@@ -661,36 +990,140 @@ typedef enum {
 /*qMemoryHeapCreate(NAME, N, ALLOC_SIZE)
 
 This macro creates and initialises a memory heap pool. The parameter alloc size
-should be of type qMEM_size_t.
+should be of type qMEM_size_t. The free blocks hold the links of the free-list,
+so the block size must be even and at least 4 bytes, otherwise the pool is 
+left empty and every allocation fails.
+Allocations that fit in a single block are served from an embedded free-list 
+in constant time. Larger allocations take contiguous blocks from the same pool,
+the run is searched on a bitmap of the free blocks, one word at a time.
 
 Parameters:
 
     - NAME : Name of the memory heap pool 
  
-    - N : Number of memory blocks
+    - N : Number of memory blocks (up to 65535)
  
     - ALLOC_SIZE: Size of each memory block
 */ 
 #define qMemoryHeapCreate(NAME, N, ALLOC_SIZE)	uint32_t qMEM_AREA_##NAME[(N*ALLOC_SIZE)>>2]={0}; \
-						uint8_t qMEM_BDES_##NAME[N]={0}; \
+						uint16_t qMEM_BDES_##NAME[N]={0}; \
+						uint32_t qMEM_FMAP_##NAME[((N)+31)>>5]={0}; \
 						qMemoryPool_t NAME; \
                                                 NAME.BlockSize = ALLOC_SIZE; \
                                                 NAME.NumberofBlocks =  N; \
                                                 NAME.BlockDescriptors = &qMEM_BDES_##NAME[0]; \
-                                                NAME.Blocks = (uint8_t*)&qMEM_AREA_##NAME[0] \
+                                                NAME.FreeMap = &qMEM_FMAP_##NAME[0]; \
+                                                NAME.Blocks = (uint8_t*)&qMEM_AREA_##NAME[0]; \
+                                                _qMemoryPoolInit(&NAME) \
                                                 
 
 
+    void _qMemoryPoolInit(qMemoryPool_t *obj);
     void* qMemoryAlloc(qMemoryPool_t *obj, const qSize_t size);
     void qMemoryFree(qMemoryPool_t *obj, void* pmem);
+    qMemoryPool_t* qSchedulerGetTaskPool(void);
+    #ifdef Q_MEMORY_STATS
+    qBool_t qMemoryGetStats(qMemoryPool_t *obj, qMemoryStats_t *Stats);
+    void qMemoryResetStats(qMemoryPool_t *obj);
+    void qMemoryTraceStats(qMemoryPool_t *obj);
+    #endif
+    
+    #define Q_MALLOC_MAX_CLASSES    8   /*max number of size classes (pools) for qMalloc*/
+    qBool_t qMallocSetup(qMemoryPool_t **Pools, const uint8_t NumberOfPools);
+    void* qMalloc(const qSize_t size);
+    void qFree(void *ptr);
+#endif
+
+#ifdef Q_MESSAGES
+    void* qMessageAlloc(qMemoryPool_t *Pool, const qSize_t Size);
+    void* qMessageRetain(void *Msg);
+    void qMessageRelease(void *Msg);
+    uint32_t qMessageRefCount(const void *Msg);
+    qBool_t qTaskSendMessage(qTask_t *Task, void *Msg);
+    qBool_t qTaskQueueMessage(qTask_t *Task, void *Msg);
+#endif
+
+#ifdef Q_CONCURRENT_POOLS
+    #define Q_CPOOL_MAGAZINE_SIZE   16  /*number of blocks cached by each thread for each pool*/
+    #define Q_CPOOL_MAGAZINE_SLOTS  4   /*number of pools that each thread can cache*/
+    #define qCPOOL_NONE             (0xFFFFFFFFul)
+    typedef struct{ /*Concurrent (thread-safe) memory pool definition*/
+        uint8_t *Blocks;
+        size_t BlockSize;
+        uint32_t NumberOfBlocks;
+        volatile uint64_t Head; /*the shared free-list head : [63:32] ABA tag, [31:0] index of the first free block*/
+    }qConcurrentPool_t;
+
+    qBool_t qConcurrentPoolInit(qConcurrentPool_t *Pool, void *Area, const size_t BlockSize, const uint32_t NumberOfBlocks);
+    void* qConcurrentPoolAlloc(qConcurrentPool_t *Pool);
+    void qConcurrentPoolFree(qConcurrentPool_t *Pool, void *ptr);
+    void qConcurrentPoolFlushCache(qConcurrentPool_t *Pool);
+#endif
+#ifdef Q_ARENA
+    typedef struct{ /*Arena (bump-pointer) allocator definition*/
+        uint8_t *Area; /*the memory region*/
+        size_t Size; /*the size of the region*/
+        size_t Offset; /*the next free byte in the region*/
+    }qArena_t;
+    typedef size_t qArenaMark_t;
+
+    qBool_t qArenaInit(qArena_t *Arena, void *Area, const size_t Size);
+    void* qArenaAlloc(qArena_t *Arena, const size_t size);
+    qArenaMark_t qArenaSave(const qArena_t *Arena);
+    void qArenaRestore(qArena_t *Arena, const qArenaMark_t Mark);
+    void qArenaReset(qArena_t *Arena);
+    size_t qArenaAvailable(const qArena_t *Arena);
+    void qSchedulerSetScratchArena(qArena_t *Arena);
+    qArena_t* qSchedulerGetScratchArena(void);
+#endif
+#ifdef Q_TLSF_HEAP
+    #ifndef Q_TLSF_FL_INDEX_MAX
+        #if defined(SIZE_MAX) && (SIZE_MAX <= 0xFFFFu)
+            #define Q_TLSF_FL_INDEX_MAX     15 /*16-bit size_t : the largest shift that fits*/
+        #else
+            #define Q_TLSF_FL_INDEX_MAX     24
+        #endif
+    #endif
+    #if (Q_TLSF_FL_INDEX_MAX > 31) || (defined(SIZE_MAX) && (0 == (SIZE_MAX >> Q_TLSF_FL_INDEX_MAX)))
+        #error "Q_TLSF_FL_INDEX_MAX must be lower than the bit width of size_t (max 31)"
+    #endif
+    #define Q_TLSF_SL_INDEX_LOG2    4 /*log2 of the number of second-level lists*/
+    #define _qTLSF_ALIGN_LOG2       ((sizeof(size_t) >= 8u)? 3 : ((sizeof(size_t) == 4u)? 2 : 1)) /*the blocks are aligned to the machine word*/
+    #define _qTLSF_FL_SHIFT         (Q_TLSF_SL_INDEX_LOG2 + _qTLSF_ALIGN_LOG2)
+    #define _qTLSF_FL_COUNT         (Q_TLSF_FL_INDEX_MAX - _qTLSF_FL_SHIFT + 1)
+    #define _qTLSF_SL_COUNT         (1 << Q_TLSF_SL_INDEX_LOG2)
+    struct _qTLSFBlock_t;
+    typedef struct{ /*Two-Level Segregated Fit heap definition*/
+        struct _qTLSFBlock_t *Blocks[_qTLSF_FL_COUNT][_qTLSF_SL_COUNT]; /*the heads of the free lists*/
+        uint32_t FLBitmap; /*first-level bitmap : bit <fl> set if any list of the class <fl> is not empty*/
+        uint32_t SLBitmap[_qTLSF_FL_COUNT]; /*second-level bitmaps*/
+    }qTLSFHeap_t;
+
+    qBool_t qTLSFHeapInit(qTLSFHeap_t *Heap, void *Area, const size_t Size);
+    void* qTLSFAlloc(qTLSFHeap_t *Heap, const size_t size);
+    void qTLSFFree(qTLSFHeap_t *Heap, void *ptr);
+    size_t qTLSFBlockSize(const void *ptr);
 #endif
     
 #ifdef Q_RINGBUFFERS     
-void qRBufferInit(qRBuffer_t *obj, void* DataBlock, const qSize_t ElementSize, const qSize_t ElementCount);
+void qRBufferInit(qRBuffer_t *obj, void* DataBlock, const qSize_t ElementSize, const qRBIndex_t ElementCount);
 qBool_t qRBufferEmpty(qRBuffer_t *obj);
 void* qRBufferGetFront(qRBuffer_t *obj);
 qBool_t qRBufferPopFront(qRBuffer_t *obj, void *dest);
 qBool_t qRBufferPush(qRBuffer_t *obj, void *data);
+qRBIndex_t qRBufferPushN(qRBuffer_t *obj, const void *data, const qRBIndex_t n);
+qRBIndex_t qRBufferPopN(qRBuffer_t *obj, void *dest, const qRBIndex_t n);
+void* qRBufferReserve(qRBuffer_t *obj, qRBIndex_t *n);
+qBool_t qRBufferCommit(qRBuffer_t *obj, const qRBIndex_t n);
+void* qRBufferPeek(qRBuffer_t *obj, qRBIndex_t *n);
+qBool_t qRBufferRelease(qRBuffer_t *obj, const qRBIndex_t n);
+#ifdef Q_RBUFFER_MPMC
+void qRBufferInitMPMC(qRBuffer_t *obj, void* DataBlock, volatile qRBIndex_t *Sequences, const qSize_t ElementSize, const qRBIndex_t ElementCount);
+#endif
+#ifdef Q_RBUFFER_OVERWRITE
+void qRBufferInitOverwrite(qRBuffer_t *obj, void* DataBlock, const qSize_t ElementSize, const qRBIndex_t ElementCount);
+uint32_t qRBufferGetOverwrites(qRBuffer_t *obj);
+#endif
 #endif
 
 typedef volatile char qISR_Byte_t;
@@ -0,0 +1,324 @@
+/*******************************************************************************
+ *  QuarkTS - A Non-Preemptive Task Scheduler for low-range MCUs
+ *  Version : 4.6.8
+ *  Copyright (C) 2012 Eng. Juan Camilo Gomez C. MSc. (kmilo17pet@gmail.com)
+ *
+ *  QuarkTS is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License (LGPL)as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  QuarkTS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+/*
+Header-only C++20 coroutine layer for QuarkTS.
+
+A task body is written as a C++20 coroutine returning QuarkTS::Coroutine.
+The coroutine is resumed only from the scheduler dispatch path, so the usual
+scheduling rules (priorities, queue, RBuffer links, parking) still apply.
+Locals are kept inside the coroutine frame, which is allocated from a
+QuarkTS memory pool (see QuarkTS::SetFramePool), never from the global heap.
+
+Example:
+
+    QuarkTS::Coroutine Blink(int *port){
+        for(;;){
+            *port ^= 1;
+            co_await QuarkTS::Delay(0.5);
+        }
+    }
+    ...
+    qMemoryHeapCreate(frames, 8, qMB_64B);
+    QuarkTS::SetFramePool(&frames);
+    QuarkTS::AddCoroutineTask(&BlinkTask, Blink(&PORTA), qMedium_Priority);
+*/
+#ifndef HPP_QuarkTS
+#define HPP_QuarkTS
+
+#include "QuarkTS.h"
+
+#if defined(__cplusplus) && (__cplusplus >= 202002L) && defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+
+namespace QuarkTS{
+
+    class Coroutine;
+    /*Base for all the awaitables: Poll is called from the dispatch path on every
+    task activation while the coroutine is suspended on the awaitable. The
+    coroutine is resumed when Poll returns true*/
+    class Awaiter{
+        public:
+            virtual bool Poll(qEvent_t e) = 0;
+            Awaiter *Next = nullptr; /*used by the objects that keep waiting lists*/
+            qTask_t *Task = nullptr; /*the task owning the suspended coroutine*/
+        protected:
+            ~Awaiter() = default;
+    };
+
+    namespace _Private{
+        inline qMemoryPool_t *FramePool = nullptr;
+        inline void Dispatcher(qEvent_t e);
+        inline bool Suspend(Awaiter *a);
+    }
+    /*============================================================================*/
+    /*void QuarkTS::SetFramePool(qMemoryPool_t *pool)
+
+    Set the memory pool from where the coroutine frames will be allocated. This
+    call is mandatory and must be done before creating any coroutine.
+
+    Parameters:
+
+        - pool : A pointer to the memory pool object (see qMemoryHeapCreate)
+    */
+    inline void SetFramePool(qMemoryPool_t *pool){
+        _Private::FramePool = pool;
+    }
+    /*============================================================================*/
+    class Coroutine{
+        public:
+            struct promise_type{
+                const _qEvent_t_ *Event = nullptr; /*the event info of the current activation*/
+                Awaiter *Waiting = nullptr; /*the awaitable where the coroutine is suspended*/
+                qTask_t *Task = nullptr; /*the task running this coroutine*/
+
+                Coroutine get_return_object() noexcept { return Coroutine(std::coroutine_handle<promise_type>::from_promise(*this)); }
+                static Coroutine get_return_object_on_allocation_failure() noexcept { return Coroutine(nullptr); }
+                std::suspend_always initial_suspend() noexcept { return {}; } /*the coroutine starts on the first dispatch*/
+                std::suspend_always final_suspend() noexcept { return {}; } /*the frame is released by the dispatcher*/
+                void return_void() noexcept {}
+                void unhandled_exception() noexcept { std::terminate(); }
+                static void* operator new(std::size_t size) noexcept {
+                    if( (nullptr == _Private::FramePool) || (size > (qSize_t)(~(qSize_t)0)) ) return nullptr;
+                    return qMemoryAlloc(_Private::FramePool, (qSize_t)size);
+                }
+                static void operator delete(void *ptr) noexcept {
+                    qMemoryFree(_Private::FramePool, ptr);
+                }
+            };
+            using Handle = std::coroutine_handle<promise_type>;
+
+            explicit Coroutine(Handle h) noexcept : h(h) {}
+            explicit Coroutine(std::nullptr_t) noexcept : h(nullptr) {}
+            Coroutine(Coroutine &&other) noexcept : h(other.h) { other.h = nullptr; }
+            Coroutine(const Coroutine&) = delete;
+            Coroutine& operator=(const Coroutine&) = delete;
+            ~Coroutine(){ if(h) h.destroy(); } /*only owned until it gets attached to a task*/
+            /*Returns true if the coroutine frame could not be allocated*/
+            bool Failed(void) const noexcept { return !h; }
+            Handle Release(void) noexcept { Handle tmp = h; h = nullptr; return tmp; }
+        private:
+            Handle h;
+    };
+    /*============================================================================*/
+    /*qBool_t QuarkTS::AddCoroutineTask(qTask_t *Task, QuarkTS::Coroutine co, qPriority_t Priority)
+
+    Add a task to the scheduling scheme running the specified C++20 coroutine.
+    The task is created as an event task (qDisabled) and it gets an initial
+    async event, so the coroutine starts on the next scheduling cycle. When the
+    coroutine returns, its frame gets released to the frame pool and the task
+    is removed from the scheduling scheme.
+
+    Note: The TaskData field of the task is used internally to hold the coroutine,
+          pass the task arguments as coroutine parameters instead.
+
+    Parameters:
+
+        - Task : A pointer to the task node.
+        - co : The coroutine object, e.g. MyCoroutine(args...)
+        - Priority : Task priority Value. [0(min) - 255(max)]
+
+    Return value:
+
+        Returns qTrue on success, otherwise returns qFalse (i.e. the frame could
+        not be allocated from the frame pool)
+    */
+    inline qBool_t AddCoroutineTask(qTask_t *Task, Coroutine &&co, qPriority_t Priority){
+        Coroutine::Handle h;
+        if( (nullptr == Task) || co.Failed() ) return qFalse;
+        h = co.Release();
+        if(!qSchedulerAddeTask(Task, _Private::Dispatcher, Priority, h.address())){
+            h.destroy();
+            return qFalse;
+        }
+        h.promise().Task = Task;
+        qTaskSendEvent(Task, nullptr); /*kick-off the coroutine*/
+        return qTrue;
+    }
+    /*============================================================================*/
+    /*co_await QuarkTS::Delay(qTime_t t)
+
+    Suspends the coroutine for the specified time (in seconds). The task is
+    parked inside the scheduler (same as qCoroutineDelay), so it will be only
+    resumed when the time expires. Events received while parked are discarded.
+    */
+    class Delay : public Awaiter{
+        public:
+            explicit Delay(qTime_t t) noexcept : t(t) {}
+            bool await_ready() const noexcept { return false; }
+            template<typename P> bool await_suspend(std::coroutine_handle<P>) noexcept {
+                if(!_Private::Suspend(this)) return false; /*only park the task if the coroutine gets suspended*/
+                _qCRParkTask(t);
+                return true;
+            }
+            void await_resume() const noexcept {}
+            bool Poll(qEvent_t) override { return (bool)_qCRParkRelease(qFalse); }
+        private:
+            qTime_t t;
+    };
+    /*============================================================================*/
+    /*void* co_await QuarkTS::Event()
+
+    Suspends the coroutine until the task receives an event from qTaskSendEvent
+    or qTaskQueueEvent.
+
+    Return value:
+
+        The event user-data (EventData field).
+    */
+    class Event : public Awaiter{
+        public:
+            bool await_ready() const noexcept { return false; }
+            template<typename P> bool await_suspend(std::coroutine_handle<P>) noexcept { return _Private::Suspend(this); }
+            void* await_resume() const noexcept { return data; }
+            bool Poll(qEvent_t e) override {
+                if( (byAsyncEvent != e->Trigger) && (byQueueExtraction != e->Trigger) ) return false;
+                data = e->EventData;
+                return true;
+            }
+        private:
+            void *data = nullptr;
+    };
+    #ifdef Q_RINGBUFFERS
+    /*============================================================================*/
+    /*co_await QuarkTS::RBufferPop(qRBuffer_t *obj, void *dest)
+
+    Suspends the coroutine until the ring buffer has data available, then pops
+    one element from the front. While waiting, the ring buffer is linked to the
+    task (qRB_COUNT mode), so the task is only dispatched when data arrives.
+
+    Parameters:
+
+        - obj : A pointer to the Ring Buffer object
+        - dest : Pointer to where the data will be written
+    */
+    class RBufferPop : public Awaiter{
+        public:
+            RBufferPop(qRBuffer_t *obj, void *dest) noexcept : obj(obj), dest(dest) {}
+            bool await_ready() noexcept { return (bool)qRBufferPopFront(obj, dest); }
+            template<typename P> bool await_suspend(std::coroutine_handle<P>) noexcept {
+                if(!_Private::Suspend(this)) return false;
+                qTaskLinkRBuffer(Task, obj, qRB_COUNT, 1);
+                return true;
+            }
+            void await_resume() const noexcept {}
+            bool Poll(qEvent_t) override {
+                if(!qRBufferPopFront(obj, dest)) return false;
+                qTaskLinkRBuffer(Task, obj, qRB_COUNT, qUnLink);
+                return true;
+            }
+        private:
+            qRBuffer_t *obj;
+            void *dest;
+    };
+    #endif
+    /*============================================================================*/
+    /*QuarkTS::Semaphore
+
+    Counting semaphore for coroutine tasks. Waiting coroutines are kept in a FIFO
+    list and the first one gets an async event when the semaphore is signaled,
+    so no polling is involved. When a waiter takes a token and more tokens are
+    left, it wakes-up the next waiter.
+
+    Usage:
+
+        co_await Sem.Wait();
+        ...
+        Sem.Signal();
+    */
+    class Semaphore{
+        public:
+            explicit Semaphore(uint16_t count) noexcept { qCoroutineSemaphoreInit(&sem, count); }
+            class Waiter : public Awaiter{
+                public:
+                    explicit Waiter(Semaphore &s) noexcept : s(s) {}
+                    bool await_ready() noexcept { return (nullptr == s.waiting) && s.TryLock(); } /*no barging over the waiters*/
+                    template<typename P> bool await_suspend(std::coroutine_handle<P>) noexcept {
+                        if(!_Private::Suspend(this)) return false;
+                        s.Enqueue(this);
+                        return true;
+                    }
+                    void await_resume() const noexcept {}
+                    bool Poll(qEvent_t) override {
+                        if(s.waiting != this) return false;  /*not our turn*/
+                        if(!s.TryLock()) return false;
+                        s.waiting = Next;
+                        if( (nullptr != Next) && (__qCRSemCount(&s.sem) > 0) ) qTaskSendEvent(Next->Task, nullptr); /*more tokens left, pass the turn to the next waiter*/
+                        return true;
+                    }
+                private:
+                    Semaphore &s;
+            };
+            Waiter Wait(void) noexcept { return Waiter(*this); }
+            void Signal(void) noexcept {
+                qCoroutineSemaphoreSignal(&sem);
+                if(nullptr != waiting) qTaskSendEvent(waiting->Task, nullptr); /*wake-up the first waiter*/
+            }
+        private:
+            qCoroutineSemaphore_t sem;
+            Awaiter *waiting = nullptr;
+            bool TryLock(void) noexcept {
+                if(__qCRSemCount(&sem) <= 0) return false;
+                __qCRSemLock(&sem);
+                return true;
+            }
+            void Enqueue(Awaiter *a) noexcept {
+                Awaiter **p = &waiting;
+                while(nullptr != *p) p = &(*p)->Next;
+                a->Next = nullptr;
+                *p = a;
+            }
+    };
+    /*============================================================================*/
+    namespace _Private{
+        inline Coroutine::promise_type* Promise(qTask_t *Task){
+            return &Coroutine::Handle::from_address(Task->TaskData).promise();
+        }
+        /*called from await_suspend: register the awaitable on the running coroutine*/
+        inline bool Suspend(Awaiter *a){
+            qTask_t *Task = qTaskSelf();
+            if(nullptr == Task) return false; /*not running from the dispatch path, don't suspend*/
+            if(_Private::Dispatcher != Task->Callback) return false;
+            a->Task = Task;
+            Promise(Task)->Waiting = a;
+            return true;
+        }
+        /*the task callback for all the coroutine tasks*/
+        inline void Dispatcher(qEvent_t e){
+            qTask_t *Task = qTaskSelf();
+            Coroutine::Handle h = Coroutine::Handle::from_address(e->TaskData);
+            Coroutine::promise_type &p = h.promise();
+            p.Event = e;
+            if( (nullptr != p.Waiting) && !p.Waiting->Poll(e) ) return; /*keep waiting*/
+            p.Waiting = nullptr;
+            h.resume();
+            if(h.done()){ /*the coroutine returned, release its frame and the task*/
+                h.destroy();
+                qTaskSuspend(Task);
+                qSchedulerRemoveTask(Task);
+            }
+        }
+    }
+}
+
+#endif
+
+#endif /* HPP_QuarkTS */
@@ -0,0 +1,100 @@
+/*
+ * Memory pool benchmark : multi-block allocations on large pools at high fill
+ * levels, plus a randomized check of the first-fit placement against a
+ * reference model.
+ *
+ * Not part of the default build (the Makefile only takes the sources one 
+ * directory below src). Build and run from the repository root:
+ *
+ *   gcc -std=c89 -O2 -DNB=40000 -Isrc/core src/test/bench/mempool_fill.c src/core/QuarkTS.c -o bin/mempool_fill -lpthread
+ *   ./bin/mempool_fill
+ *
+ * NB is the number of 16-byte blocks of the pool (up to 65535). The previous 
+ * descriptor walk can be measured with NB=255 against the sources of the 
+ * commit before the bitmap search (its block counts were 8-bit).
+ */
+#define _POSIX_C_SOURCE	199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "QuarkTS.h"
+
+#ifndef NB
+#define NB          4000
+#endif
+#define BLOCK       16
+#define ROUNDS      200000L
+#define PAIRS       20000L
+
+static uint8_t Owner[NB]; /*the reference model : one byte per block, set while allocated*/
+static void *Ptrs[NB];
+static uint16_t Lens[NB];
+static int nLive = 0;
+/*============================================================================*/
+static double NowNs(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec*1e9 + (double)t.tv_nsec;
+}
+/*============================================================================*/
+static int FirstFit(const int k){ /*the first run of k free blocks in the model, -1 if none*/
+    int j, run = 0;
+    for(j = 0; j < NB; j++){
+        if(Owner[j]) run = 0;
+        else if(++run >= k) return j - k + 1;
+    }
+    return -1;
+}
+/*============================================================================*/
+int main(void){
+    long it, bad = 0;
+    int i, j, k, idx, ref;
+    double t0, t1;
+    void *p;
+    qMemoryHeapCreate(pool, NB, BLOCK);
+    srand(1);
+    for(it = 0; it < ROUNDS; it++){ /*random mix of frees and allocations (one in four spans several blocks)*/
+        if(nLive > 0 && (rand() & 1)){
+            i = rand() % nLive;
+            idx = (int)(((uint8_t*)Ptrs[i] - pool.Blocks)/BLOCK);
+            for(j = 0; j < Lens[i]; j++){
+                if(!Owner[idx + j]) bad++;
+                Owner[idx + j] = 0u;
+            }
+            qMemoryFree(&pool, Ptrs[i]);
+            Ptrs[i] = Ptrs[--nLive];
+            Lens[i] = Lens[nLive];
+            continue;
+        }
+        k = (0 == rand() % 4)? 1 + rand() % 40 : 1;
+        p = qMemoryAlloc(&pool, (qSize_t)(k*BLOCK));
+        ref = FirstFit(k);
+        if(NULL == p){
+            if(ref >= 0) bad++; /*the model found room*/
+            continue;
+        }
+        idx = (int)(((uint8_t*)p - pool.Blocks)/BLOCK);
+        if(k > 1 && idx != ref) bad++; /*the runs must keep the first-fit placement*/
+        for(j = 0; j < k; j++){
+            if(Owner[idx + j]) bad++; /*overlap*/
+            Owner[idx + j] = 1u;
+        }
+        Ptrs[nLive] = p;
+        Lens[nLive++] = (uint16_t)k;
+    }
+    printf("blocks=%d model mismatches=%ld\n", NB, bad);
+    while(nLive > 0) qMemoryFree(&pool, Ptrs[--nLive]);
+    for(i = 0; i < NB; i++) Ptrs[i] = qMemoryAlloc(&pool, BLOCK); /*fill the pool, then punch random single-block holes (90% fill)*/
+    for(i = 0; i < NB; i++) if(0 == rand() % 10) qMemoryFree(&pool, Ptrs[i]);
+    for(k = 2; k <= 8; k <<= 1){
+        t0 = NowNs();
+        for(it = 0; it < PAIRS; it++){
+            p = qMemoryAlloc(&pool, (qSize_t)(k*BLOCK));
+            if(NULL != p) qMemoryFree(&pool, p);
+        }
+        t1 = NowNs();
+        printf("90%% fill, %d-block alloc+free : %.1f ns/op\n", k, (t1 - t0)/(double)PAIRS);
+    }
+    return (0 == bad)? EXIT_SUCCESS : EXIT_FAILURE;
+}
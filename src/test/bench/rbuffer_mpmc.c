@@ -0,0 +1,111 @@
+/*
+ * Ring buffer benchmark : NP producer threads and NC consumer threads share a 
+ * 1024-slot ring buffer, first as a lock-free MPMC ring (qRBufferInitMPMC), 
+ * then as a plain ring protected by a mutex. Every element must be delivered 
+ * exactly once.
+ *
+ * Not part of the default build (the Makefile only takes the sources one 
+ * directory below src). Build and run from the repository root:
+ *
+ *   gcc -std=gnu89 -O2 -Isrc/core src/test/bench/rbuffer_mpmc.c src/core/QuarkTS.c -o bin/rbuffer_mpmc -lpthread
+ *   ./bin/rbuffer_mpmc
+ */
+#define _POSIX_C_SOURCE	199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "QuarkTS.h"
+
+#ifndef PER_PRODUCER
+#define PER_PRODUCER    1000000u
+#endif
+#define MAX_THREADS     8
+
+static qRBuffer_t Ring;
+static uint32_t RingStorage[1024];
+static volatile qRBIndex_t RingSequences[1024];
+static pthread_mutex_t RingMutex = PTHREAD_MUTEX_INITIALIZER;
+static int Locked = 0, nProducers = 0;
+static uint8_t *Seen;
+static volatile uint32_t Consumed = 0u, Duplicated = 0u;
+/*============================================================================*/
+static double NowSec(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec*1e-9;
+}
+/*============================================================================*/
+static qBool_t Push(uint32_t *v){
+    qBool_t RetValue;
+    if(!Locked) return qRBufferPush(&Ring, v);
+    pthread_mutex_lock(&RingMutex);
+    RetValue = qRBufferPush(&Ring, v);
+    pthread_mutex_unlock(&RingMutex);
+    return RetValue;
+}
+/*============================================================================*/
+static qBool_t Pop(uint32_t *v){
+    qBool_t RetValue;
+    if(!Locked) return qRBufferPopFront(&Ring, v);
+    pthread_mutex_lock(&RingMutex);
+    RetValue = qRBufferPopFront(&Ring, v);
+    pthread_mutex_unlock(&RingMutex);
+    return RetValue;
+}
+/*============================================================================*/
+static void* Producer(void *arg){
+    uint32_t i = 0u, v, base = (uint32_t)(long)arg*PER_PRODUCER;
+    while(i < PER_PRODUCER){
+        v = base + i;
+        if(Push(&v)) i++;
+        else sched_yield();
+    }
+    return NULL;
+}
+/*============================================================================*/
+static void* Consumer(void *arg){
+    uint32_t v;
+    while(__atomic_load_n(&Consumed, __ATOMIC_RELAXED) < (uint32_t)nProducers*PER_PRODUCER){
+        if(Pop(&v)){
+            if(__atomic_exchange_n(&Seen[v], 1u, __ATOMIC_RELAXED)) __atomic_fetch_add(&Duplicated, 1u, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&Consumed, 1u, __ATOMIC_RELAXED);
+        }
+        else sched_yield();
+    }
+    return arg;
+}
+/*============================================================================*/
+static int Run(const int np, const int nc, const int locked){
+    pthread_t t[2*MAX_THREADS];
+    uint32_t i, missing = 0u;
+    double dt;
+    int k;
+    nProducers = np;
+    Locked = locked;
+    Consumed = Duplicated = 0u;
+    Seen = (uint8_t*)calloc((size_t)np*PER_PRODUCER, 1u);
+    if(NULL == Seen) return 1;
+    if(locked) qRBufferInit(&Ring, RingStorage, sizeof(uint32_t), 1024);
+    else qRBufferInitMPMC(&Ring, RingStorage, RingSequences, sizeof(uint32_t), 1024);
+    dt = NowSec();
+    for(k = 0; k < np; k++) pthread_create(&t[k], NULL, Producer, (void*)(long)k);
+    for(k = 0; k < nc; k++) pthread_create(&t[np + k], NULL, Consumer, NULL);
+    for(k = 0; k < np + nc; k++) pthread_join(t[k], NULL);
+    dt = NowSec() - dt;
+    for(i = 0u; i < (uint32_t)np*PER_PRODUCER; i++) if(!Seen[i]) missing++;
+    free(Seen);
+    printf("%dP/%dC %-5s : %6.1f Mops/s, duplicated=%lu, missing=%lu\n", np, nc, locked? "mutex" : "MPMC", (double)np*PER_PRODUCER/dt/1e6, (unsigned long)Duplicated, (unsigned long)missing);
+    return (0u == Duplicated && 0u == missing)? 0 : 1;
+}
+/*============================================================================*/
+int main(void){
+    int n, errors = 0;
+    for(n = 1; n <= MAX_THREADS; n <<= 1){
+        errors += Run(n, n, 0);
+        errors += Run(n, n, 1);
+    }
+    return (0 == errors)? EXIT_SUCCESS : EXIT_FAILURE;
+}
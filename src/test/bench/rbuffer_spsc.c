@@ -0,0 +1,63 @@
+/*
+ * Ring buffer benchmark : one capture thread pushes a sequence of uint32 
+ * samples into a 1024-element ring buffer while the main thread pops them and
+ * checks their order (single-producer/single-consumer protocol).
+ *
+ * Not part of the default build (the Makefile only takes the sources one 
+ * directory below src). Build and run from the repository root:
+ *
+ *   gcc -std=gnu89 -O2 -Isrc/core src/test/bench/rbuffer_spsc.c src/core/QuarkTS.c -o bin/rbuffer_spsc -lpthread
+ *   ./bin/rbuffer_spsc
+ *
+ * Add -fsanitize=thread to check the index publication for data races.
+ */
+#define _POSIX_C_SOURCE	199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "QuarkTS.h"
+
+#ifndef SAMPLES
+#define SAMPLES     20000000ul
+#endif
+
+static qRBuffer_t Ring;
+static uint32_t RingStorage[1024];
+/*============================================================================*/
+static double NowSec(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec*1e-9;
+}
+/*============================================================================*/
+static void* CaptureThread(void *arg){
+    uint32_t i = 0u;
+    while(i < SAMPLES){
+        if(qRBufferPush(&Ring, &i)) i++;
+        else sched_yield(); /*full, let the consumer run*/
+    }
+    return arg;
+}
+/*============================================================================*/
+int main(void){
+    pthread_t producer;
+    uint32_t v, expected = 0u, bad = 0u;
+    double t;
+    qRBufferInit(&Ring, RingStorage, sizeof(uint32_t), 1024);
+    t = NowSec();
+    pthread_create(&producer, NULL, CaptureThread, NULL);
+    while(expected < SAMPLES){
+        if(qRBufferPopFront(&Ring, &v)){
+            if(v != expected) bad++;
+            expected++;
+        }
+        else sched_yield(); /*empty, let the producer run*/
+    }
+    pthread_join(producer, NULL);
+    t = NowSec() - t;
+    printf("%lu samples : %.1f Msamples/s (%.1f MB/s), sequence errors=%lu\n", (unsigned long)SAMPLES, (double)SAMPLES/t/1e6, (double)SAMPLES*4.0/t/1e6, (unsigned long)bad);
+    return (0u == bad)? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -139,32 +139,413 @@ void IdleTaskCallback(qEvent_t e){
 }
 /*============================================================================*/
 void blinktaskCallback(qEvent_t e){
-    static qSTimer_t tmr;
     qCRPosition_t state;
     qCoroutineSemaphore_t mutex;
     qCoroutineSemaphoreInit(&mutex, 1);
     qCoroutineBegin{
         qTraceMessage("");
         qCoroutinePositionGet(state);
-        qSTimerSet(&tmr, 1);
-        qCoroutineWaitUntil( qSTimerExpired(&tmr) );
+        qCoroutineDelay(1);
         
         qCoroutineSemaphoreWait(&mutex);
         qCoroutinePositionGet(state);
-        qSTimerSet(&tmr, 1);
         /**/
         
         /*qCoroutinePositionRestore(state);*/
         qCoroutineSemaphoreSignal(&mutex);
         qTraceMessage("");
         qTaskSendEvent(&Task1, NULL);
-        qCoroutineWaitUntil(qSTimerExpired(&tmr));
+        qCoroutineDelay(1);
         qTraceMessage("");
-        qSTimerSet(&tmr, 0.5);
-        qCoroutineWaitUntil(qSTimerExpired(&tmr));
+        qCoroutineWaitUntilTimeout(e->Trigger == byAsyncEvent, 0.5);
     }qCoroutineEnd;
 }
 /*============================================================================*/
+/* Regression checks : each one sets up its own scheduler instance, runs it 
+   with a manual tick from the idle task and verifies the outcome with assert. */
+static uint32_t CheckIdleCycles = 0u;
+static uint32_t CheckIdleLimit = 0u;
+void CheckIdleCallback(qEvent_t e){
+    qSchedulerSysTick(); /*one tick per idle cycle, so the checks don't depend on the wall clock*/
+    if(++CheckIdleCycles >= CheckIdleLimit) qSchedulerRelease();
+}
+static void CheckSchedulerRun(const uint32_t IdleCycles){
+    CheckIdleCycles = 0u;
+    CheckIdleLimit = IdleCycles;
+    qSchedulerRun();
+}
+/*============================================================================*/
+static int PooledPhase = 0;
+void PooledCoroutineCallback(qEvent_t e){
+    qCRTaskBegin{
+        PooledPhase = 1;
+        qCRDelay(0.05);
+        PooledPhase = 2;
+    }qCREnd;
+}
+static void CheckPooledCoroutine(void){ /*a single-shot pooled task must not be reclaimed while its coroutine is parked*/
+    #ifdef Q_MEMORY_STATS
+    qMemoryStats_t Stats;
+    #endif
+    qSchedulerSetup(0.01, CheckIdleCallback, 10);
+    qSchedulerSetupTaskPool(2);
+    PooledPhase = 0;
+    assert(NULL != qTaskCreate(PooledCoroutineCallback, qMedium_Priority, 0.01, 1, qEnabled, NULL));
+    CheckSchedulerRun(50u);
+    assert(2 == PooledPhase);
+    #ifdef Q_MEMORY_STATS
+    assert(qMemoryGetStats(qSchedulerGetTaskPool(), &Stats));
+    assert(1u == Stats.Allocations && 1u == Stats.Frees && 0u == Stats.BlocksInUse);
+    #endif
+}
+/*============================================================================*/
+static void CheckMemoryPool(void){ /*single-block free-list, contiguous runs and the pools that can't hold the free-list links*/
+    void *a, *b, *c;
+    qMemoryHeapCreate(pool, 8, qMB_16B);
+    qMemoryHeapCreate(tiny, 4, 3);
+    a = qMemoryAlloc(&pool, 10);
+    b = qMemoryAlloc(&pool, 40); /*three contiguous blocks*/
+    c = qMemoryAlloc(&pool, 16);
+    assert(NULL != a && NULL != b && NULL != c);
+    assert((uint8_t*)b + 48 <= (uint8_t*)c || (uint8_t*)c + 16 <= (uint8_t*)b);
+    assert(NULL == qMemoryAlloc(&pool, 64)); /*only three blocks left*/
+    qMemoryFree(&pool, b);
+    assert(NULL != (b = qMemoryAlloc(&pool, 48)));
+    qMemoryFree(&pool, a);
+    qMemoryFree(&pool, b);
+    qMemoryFree(&pool, c);
+    assert(NULL != (a = qMemoryAlloc(&pool, 128))); /*every block is free again*/
+    qMemoryFree(&pool, a);
+    assert(NULL == qMemoryAlloc(&tiny, 1)); /*3-byte blocks are rejected*/
+}
+/*============================================================================*/
+#ifdef Q_TASK_GROUPS
+static qTask_t GroupMember[3], GroupJoin;
+static qTaskGroup_t Group;
+static void *GroupResults[3];
+static int GroupForks = 0, GroupOthers = 0, GroupJoins = 0;
+void GroupMemberCallback(qEvent_t e){
+    if(byAsyncEvent != e->Trigger) return;
+    if(0 == strcmp((char*)e->EventData, "fork")){
+        GroupForks++;
+        qTaskGroupSetResult(e->TaskData);
+    }
+    else GroupOthers++; /*an unrelated event is not the member completion*/
+}
+void GroupJoinCallback(qEvent_t e){
+    if(byAsyncEvent == e->Trigger && (void*)&Group == e->EventData) GroupJoins++;
+}
+static void CheckTaskGroup(void){ /*fork-join with an unrelated event in between, then a member removed before completing*/
+    qTask_t *Members[3] = {&GroupMember[0], &GroupMember[1], &GroupMember[2]};
+    qSchedulerSetup(0.01, CheckIdleCallback, 10);
+    qSchedulerAddeTask(&GroupMember[0], GroupMemberCallback, qHigh_Priority, "A");
+    qSchedulerAddeTask(&GroupMember[1], GroupMemberCallback, qHigh_Priority, "B");
+    qSchedulerAddeTask(&GroupMember[2], GroupMemberCallback, qHigh_Priority, "C");
+    qSchedulerAddeTask(&GroupJoin, GroupJoinCallback, qLowest_Priority, NULL);
+    GroupForks = GroupOthers = GroupJoins = 0;
+    assert(qTaskGroupInit(&Group, Members, GroupResults, 3, &GroupJoin));
+    assert(qTaskGroupStart(&Group, "fork"));
+    assert(!qTaskGroupStart(&Group, "fork")); /*not joined yet*/
+    qTaskSendEvent(&GroupMember[0], "other");
+    CheckSchedulerRun(10u);
+    assert(3 == GroupForks && 1 == GroupOthers && 1 == GroupJoins);
+    assert(!qTaskGroupIsBusy(&Group));
+    assert(0 == strcmp((char*)GroupResults[0], "A") && 0 == strcmp((char*)GroupResults[2], "C"));
+    assert(qTaskGroupStart(&Group, "fork"));
+    qSchedulerRemoveTask(&GroupMember[1]); /*completes with a NULL result and leaves the group*/
+    CheckSchedulerRun(10u);
+    assert(5 == GroupForks && 2 == GroupJoins && NULL == GroupResults[1]);
+    assert(!qTaskGroupStart(&Group, "fork"));
+}
+#endif
+/*============================================================================*/
+#ifdef Q_TIMER_SERVICE
+static qTask_t TimerServiceTask;
+static qCBTimer_t OneShotTimer, ReloadTimer, LongTimer, StoppedTimer;
+static uint32_t OneShotAt = 0u, LongAt = 0u, StoppedFired = 0u;
+static uint32_t ReloadFired = 0u;
+void CheckTimerCallback(qCBTimer_t *Timer){
+    if(&OneShotTimer == Timer) OneShotAt = CheckIdleCycles;
+    else if(&LongTimer == Timer) LongAt = CheckIdleCycles; /*beyond the first level, it gets cascaded*/
+    else if(&ReloadTimer == Timer){
+        if(++ReloadFired == 5u) qCBTimerStop(Timer); /*stopped from its own callback*/
+    }
+    else StoppedFired++;
+}
+static void CheckTimerWheel(void){ /*expiration time of the one-shot, auto-reload and cascaded timers*/
+    qSchedulerSetup(0.01, CheckIdleCallback, 10);
+    assert(qCBTimerServiceStart(&TimerServiceTask, qHigh_Priority));
+    assert(qCBTimerStart(&OneShotTimer, CheckTimerCallback, NULL, 0.05, qFalse));
+    assert(qCBTimerStart(&ReloadTimer, CheckTimerCallback, NULL, 0.03, qTrue));
+    assert(qCBTimerStart(&LongTimer, CheckTimerCallback, NULL, 3.0, qFalse));
+    assert(qCBTimerStart(&StoppedTimer, CheckTimerCallback, NULL, 0.02, qFalse));
+    assert(qCBTimerStop(&StoppedTimer) && !qCBTimerStop(&StoppedTimer));
+    assert(qCBTimerRemaining(&LongTimer) >= 299u && qCBTimerRemaining(&LongTimer) <= 301u);
+    CheckSchedulerRun(400u);
+    assert(OneShotAt >= 4u && OneShotAt <= 6u);
+    assert(LongAt >= 299u && LongAt <= 302u);
+    assert(5u == ReloadFired && 0u == StoppedFired);
+    assert(!qCBTimerIsActive(&OneShotTimer) && !qCBTimerIsActive(&ReloadTimer) && !qCBTimerIsActive(&LongTimer));
+}
+#endif
+/*============================================================================*/
+#ifdef Q_DEFERRED_CALLS
+#define DEFERRED_PER_THREAD     2000
+static qTask_t DeferringTask;
+static char DeferredOrder[8];
+static int DeferredRuns = 0;
+static volatile int DeferredThreadCalls = 0;
+void DeferredRecord(void *Arg){
+    if(DeferredRuns < (int)sizeof(DeferredOrder) - 1) DeferredOrder[DeferredRuns] = *(char*)Arg;
+    DeferredRuns++;
+}
+void DeferredCount(void *Arg){
+    DeferredThreadCalls++; /*only modified from the scheduler context*/
+}
+void DeferringTaskCallback(qEvent_t e){
+    static char c = 'e';
+    assert(qDeferredCall(DeferredRecord, &c)); /*deferred from the task context, runs on the next scheduling cycle*/
+}
+static void DeferredPause(void){
+    struct timespec pause={0, 10000};
+    nanosleep(&pause, NULL);
+}
+void* DeferringThread(void *arg){
+    int i;
+    for(i = 0; i < DEFERRED_PER_THREAD; i++){
+        while(!qDeferredCall(DeferredCount, NULL)) DeferredPause(); /*the queue is full, wait for the scheduler*/
+    }
+    return arg;
+}
+void DeferredIdleCallback(qEvent_t e){
+    qSchedulerSysTick();
+    if(2*DEFERRED_PER_THREAD == DeferredThreadCalls) qSchedulerRelease();
+    else DeferredPause();
+}
+static void CheckDeferredProducers(void){ /*two threads deferring through a small queue*/
+    pthread_t producers[2];
+    qSchedulerSetup(0.01, DeferredIdleCallback, 10);
+    qSchedulerSetupDeferredCalls(8);
+    DeferredThreadCalls = 0;
+    pthread_create(&producers[0], NULL, DeferringThread, NULL);
+    pthread_create(&producers[1], NULL, DeferringThread, NULL);
+    qSchedulerRun();
+    pthread_join(producers[0], NULL);
+    pthread_join(producers[1], NULL);
+    assert(2*DEFERRED_PER_THREAD == DeferredThreadCalls);
+}
+static void CheckDeferredCalls(void){ /*FIFO order and full queue*/
+    static char a = 'a', b = 'b', c = 'c', d = 'd';
+    qSchedulerSetup(0.01, CheckIdleCallback, 10);
+    assert(!qDeferredCall(DeferredRecord, &a)); /*the queue was not created*/
+    qSchedulerSetupDeferredCalls(4);
+    DeferredRuns = 0;
+    memset(DeferredOrder, 0, sizeof(DeferredOrder));
+    assert(qDeferredCall(DeferredRecord, &a) && qDeferredCall(DeferredRecord, &b));
+    assert(qDeferredCall(DeferredRecord, &c) && qDeferredCall(DeferredRecord, &d));
+    assert(!qDeferredCall(DeferredRecord, &a)); /*full*/
+    qSchedulerAddxTask(&DeferringTask, DeferringTaskCallback, qMedium_Priority, 0.01, 1, qEnabled, NULL);
+    CheckSchedulerRun(5u);
+    assert(5 == DeferredRuns && 0 == strcmp(DeferredOrder, "abcde"));
+    CheckDeferredProducers();
+}
+#endif
+/*============================================================================*/
+#ifdef Q_TLSF_HEAP
+#define TLSF_CHECK_BLOCKS       48
+static size_t TLSFArea[4096/sizeof(size_t)];
+static void CheckTLSFHeap(void){ /*alignment, no overlaps, coalescing and exhaustion*/
+    qTLSFHeap_t heap;
+    uint8_t *blocks[TLSF_CHECK_BLOCKS];
+    size_t sizes[TLSF_CHECK_BLOCKS];
+    uint8_t *big;
+    int i, j, n, pass;
+    assert(!qTLSFHeapInit(&heap, TLSFArea, 8u)); /*too small*/
+    assert(qTLSFHeapInit(&heap, TLSFArea, sizeof(TLSFArea)));
+    assert(NULL == qTLSFAlloc(&heap, 0u));
+    assert(NULL == qTLSFAlloc(&heap, 2u*sizeof(TLSFArea)));
+    assert(NULL != (big = qTLSFAlloc(&heap, 3000u)));
+    qTLSFFree(&heap, big);
+    for(pass = 0; pass < 2; pass++){
+        for(n = 0; n < TLSF_CHECK_BLOCKS; n++){
+            sizes[n] = 1u + (size_t)((n*37 + pass*11) % 150);
+            if(NULL == (blocks[n] = qTLSFAlloc(&heap, sizes[n]))) break; /*exhausted*/
+            assert(0u == ((size_t)blocks[n] & (sizeof(size_t) - 1u)));
+            assert(qTLSFBlockSize(blocks[n]) >= sizes[n]);
+            assert(blocks[n] >= (uint8_t*)TLSFArea && blocks[n] + sizes[n] <= (uint8_t*)TLSFArea + sizeof(TLSFArea));
+            memset(blocks[n], n, sizes[n]);
+        }
+        assert(n > 16);
+        for(i = 0; i < n; i++){
+            for(j = 0; j < n; j++){
+                if(i != j) assert(blocks[i] + sizes[i] <= blocks[j] || blocks[j] + sizes[j] <= blocks[i]);
+            }
+            for(j = 0; j < (int)sizes[i]; j++) assert(i == blocks[i][j]);
+        }
+        for(i = 0; i < n; i += 2) qTLSFFree(&heap, blocks[i]); /*leave holes, then release the rest*/
+        qTLSFFree(&heap, blocks[0]); /*double free is ignored*/
+        for(i = 1; i < n; i += 2) qTLSFFree(&heap, blocks[i]);
+        assert(NULL != (big = qTLSFAlloc(&heap, 3000u))); /*the free neighbors were merged back*/
+        qTLSFFree(&heap, big);
+    }
+}
+#endif
+/*============================================================================*/
+#ifdef Q_ARENA
+static size_t ArenaArea[256/sizeof(size_t)];
+static qTask_t ScratchTask;
+static void *ScratchPtr = NULL;
+static int ScratchRuns = 0;
+void ScratchTaskCallback(qEvent_t e){
+    qArena_t *scratch = qSchedulerGetScratchArena();
+    void *p = qArenaAlloc(scratch, 100u);
+    assert(NULL != p && (NULL == ScratchPtr || p == ScratchPtr)); /*the scratch was reset after the previous dispatch*/
+    ScratchPtr = p;
+    ScratchRuns++;
+}
+static void CheckArena(void){ /*alignment, save-points, exhaustion and the scheduler scratch*/
+    qArena_t arena;
+    uint8_t *a, *b, *c;
+    qArenaMark_t mark;
+    assert(!qArenaInit(&arena, ArenaArea, 0u));
+    assert(qArenaInit(&arena, ArenaArea, sizeof(ArenaArea)));
+    assert(sizeof(ArenaArea) == qArenaAvailable(&arena));
+    a = qArenaAlloc(&arena, 1u);
+    b = qArenaAlloc(&arena, 3u);
+    assert(NULL != a && NULL != b && b >= a + 1);
+    assert(0u == ((size_t)b & (sizeof(size_t) - 1u)));
+    mark = qArenaSave(&arena);
+    c = qArenaAlloc(&arena, 16u);
+    assert(NULL != c && c >= b + 3);
+    qArenaRestore(&arena, mark);
+    assert(c == (uint8_t*)qArenaAlloc(&arena, 16u)); /*the memory after the save-point was released*/
+    qArenaRestore(&arena, mark);
+    qArenaRestore(&arena, sizeof(ArenaArea)); /*a save-point can't go forward*/
+    assert(mark == qArenaSave(&arena));
+    assert(NULL == qArenaAlloc(&arena, qArenaAvailable(&arena) + 1u));
+    qArenaReset(&arena);
+    assert((void*)ArenaArea == qArenaAlloc(&arena, sizeof(ArenaArea)));
+    assert(0u == qArenaAvailable(&arena) && NULL == qArenaAlloc(&arena, 1u));
+    qArenaReset(&arena);
+    qSchedulerSetup(0.01, CheckIdleCallback, 10);
+    qSchedulerAddxTask(&ScratchTask, ScratchTaskCallback, qMedium_Priority, 0.01, 5, qEnabled, NULL);
+    qSchedulerSetScratchArena(&arena);
+    assert(&arena == qSchedulerGetScratchArena());
+    ScratchRuns = 0;
+    CheckSchedulerRun(10u);
+    qSchedulerSetScratchArena(NULL);
+    assert(5 == ScratchRuns && (void*)ArenaArea == ScratchPtr);
+    assert(sizeof(ArenaArea) == qArenaAvailable(&arena));
+}
+#endif
+/*============================================================================*/
+#ifdef Q_RBUFFER_MPMC
+#define MPMC_PER_PRODUCER       5000
+static qRBuffer_t MPMCRing;
+static uint32_t MPMCData[16];
+static volatile qRBIndex_t MPMCSequences[16];
+static qTask_t MPMCTask1, MPMCTask2;
+static uint8_t MPMCSeen[2*MPMC_PER_PRODUCER];
+static volatile int MPMCTaken = 0, MPMCThreadTaken = 0;
+static volatile int MPMCProducersDone = 0;
+static void MPMCTake(uint32_t value){
+    assert(value < 2u*MPMC_PER_PRODUCER && 0u == MPMCSeen[value]); /*every element is delivered exactly once*/
+    MPMCSeen[value] = 1u;
+}
+void MPMCTaskCallback(qEvent_t e){
+    assert(byRBufferPop == e->Trigger);
+    MPMCTake(*(uint32_t*)e->EventData);
+    MPMCTaken++;
+}
+void* MPMCProducer(void *arg){
+    uint32_t value, first = (uint32_t)(size_t)arg;
+    for(value = first; value < first + MPMC_PER_PRODUCER; value++){
+        while(!qRBufferPush(&MPMCRing, &value)) sched_yield(); /*full, wait for the consumers*/
+    }
+    __atomic_add_fetch(&MPMCProducersDone, 1, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+void* MPMCConsumer(void *arg){
+    uint32_t value;
+    while(__atomic_load_n(&MPMCProducersDone, __ATOMIC_SEQ_CST) < 2 || !qRBufferEmpty(&MPMCRing)){
+        if(qRBufferPopFront(&MPMCRing, &value)){
+            MPMCTake(value); /*the consumers never get the same value, so the flags don't race*/
+            MPMCThreadTaken++;
+        }
+        else sched_yield();
+    }
+    return arg;
+}
+void MPMCIdleCallback(qEvent_t e){
+    qSchedulerSysTick();
+    if(2 == __atomic_load_n(&MPMCProducersDone, __ATOMIC_SEQ_CST) && qRBufferEmpty(&MPMCRing)) qSchedulerRelease();
+}
+static void CheckMPMCRing(void){ /*FIFO order, full/empty, size cap and producers/consumers in threads and tasks*/
+    pthread_t producers[2], consumer;
+    uint32_t value, expected, i;
+    memset(&MPMCRing, 0, sizeof(MPMCRing));
+    qRBufferInitMPMC(&MPMCRing, NULL, MPMCSequences, sizeof(uint32_t), 16u);
+    assert(NULL == MPMCRing.Sequences); /*rejected without a data block*/
+    qRBufferInitMPMC(&MPMCRing, MPMCData, MPMCSequences, sizeof(uint32_t), 6u);
+    assert(4u == MPMCRing.Elementcount); /*the next lower power of two*/
+    assert(qRBufferEmpty(&MPMCRing) && !qRBufferPopFront(&MPMCRing, &value));
+    for(i = 0u; i < 40u; i++){ /*several laps around the slots*/
+        assert(qRBufferPush(&MPMCRing, &i));
+        if(3u == (i & 3u)){
+            value = 100u;
+            assert(!qRBufferPush(&MPMCRing, &value)); /*full*/
+            assert(0u == qRBufferPushN(&MPMCRing, &value, 1u)); /*the bulk calls are SPSC only*/
+            for(expected = i - 3u; expected <= i; expected++){
+                assert(expected == *(uint32_t*)qRBufferGetFront(&MPMCRing));
+                assert(qRBufferPopFront(&MPMCRing, &value) && expected == value);
+            }
+            assert(qRBufferEmpty(&MPMCRing));
+        }
+    }
+    qRBufferInitMPMC(&MPMCRing, MPMCData, MPMCSequences, sizeof(uint32_t), 16u);
+    memset(MPMCSeen, 0, sizeof(MPMCSeen));
+    MPMCTaken = MPMCThreadTaken = MPMCProducersDone = 0;
+    qSchedulerSetup(0.01, MPMCIdleCallback, 10);
+    qSchedulerAddeTask(&MPMCTask1, MPMCTaskCallback, qMedium_Priority, NULL);
+    qSchedulerAddeTask(&MPMCTask2, MPMCTaskCallback, qHigh_Priority, NULL);
+    qTaskLinkRBuffer(&MPMCTask1, &MPMCRing, qRB_AUTOPOP, qLink);
+    qTaskLinkRBuffer(&MPMCTask2, &MPMCRing, qRB_AUTOPOP, qLink);
+    pthread_create(&producers[0], NULL, MPMCProducer, (void*)0);
+    pthread_create(&producers[1], NULL, MPMCProducer, (void*)(size_t)MPMC_PER_PRODUCER);
+    pthread_create(&consumer, NULL, MPMCConsumer, NULL);
+    qSchedulerRun();
+    pthread_join(producers[0], NULL);
+    pthread_join(producers[1], NULL);
+    pthread_join(consumer, NULL);
+    assert(MPMCTaken > 0 && 2*MPMC_PER_PRODUCER == MPMCTaken + MPMCThreadTaken); /*the tasks took their share*/
+    for(i = 0u; i < 2u*MPMC_PER_PRODUCER; i++) assert(1u == MPMCSeen[i]);
+}
+#endif
+/*============================================================================*/
+static void RunChecks(void){
+    CheckPooledCoroutine();
+    CheckMemoryPool();
+    #ifdef Q_TASK_GROUPS
+    CheckTaskGroup();
+    #endif
+    #ifdef Q_TIMER_SERVICE
+    CheckTimerWheel();
+    #endif
+    #ifdef Q_DEFERRED_CALLS
+    CheckDeferredCalls();
+    #endif
+    #ifdef Q_TLSF_HEAP
+    CheckTLSFHeap();
+    #endif
+    #ifdef Q_ARENA
+    CheckArena();
+    #endif
+    #ifdef Q_RBUFFER_MPMC
+    CheckMPMCRing();
+    #endif
+    puts("checks passed");
+}
+/*============================================================================*/
 uint32_t qStringHash(const char* s, uint8_t mode){
     uint32_t hash;
     switch(mode){
@@ -196,6 +577,9 @@ int main(int argc, char** argv) {
     void *memtest;
     int x=5 , y=6;
     
+    RunChecks();
+    if(argc > 1 && 0 == strcmp(argv[1], "--checks")) return EXIT_SUCCESS; /*only run the regression checks*/
+    
     qSetDebugFcn(putcharfcn);
            
     qEdgeCheck_Initialize(&INPUTS, QREG_32BIT, 10);